@@ -3,12 +3,33 @@
 
 #include <stdint.h>
 
+#include "config.h"
+
+// Frame de aquisição: amostras brutas e métricas calculadas numa única passada
+typedef struct {
+    int16_t samples[NUM_SAMPLES]; // Amostras brutas do ADS1115
+    float rms;                    // RMS do sinal AC (V, só no ponto flutuante)
+    float peak;                   // Pico amostral |AC| (V, só no ponto flutuante)
+    float true_peak;              // Pico interpolado |AC| (V), igual a peak se desabilitado
+    int64_t sum_squares;          // Soma dos quadrados AC em contagens (só no ponto fixo)
+    uint32_t rms_q4;              // RMS do sinal AC em contagens Q4 (ambos os caminhos)
+    int32_t true_peak_counts;     // Pico interpolado |AC| em contagens (ambos os caminhos)
+} adc_frame_t;
+
 int adc_init(void);
 
 int16_t adc_read_sample(int handle);
 
+void adc_read_frame(int handle, adc_frame_t *frame);
+
+void adc_process_frame(adc_frame_t *frame);
+
+void adc_process_frame_float(adc_frame_t *frame);
+
+void adc_process_frame_fixed(adc_frame_t *frame);
+
 float adc_calculate_rms(int handle);
 
 int16_t swap_bytes(int16_t val);
 
-#endif // ADC_H
\ No newline at end of file
+#endif // ADC_H
@@ -0,0 +1,63 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "adc.h"
+#include "config.h"
+
+#define ARCHIVE_MAGIC 0x42414753        // "SGAB" em little-endian
+#define ARCHIVE_HEADER_SIZE 28
+#define ARCHIVE_BLOCK_SAMPLES (ARCHIVE_BLOCK_FRAMES * NUM_SAMPLES)
+#define ARCHIVE_MAX_BYTES_PER_SAMPLE ((ARCHIVE_RICE_LIMIT + 32 + 7) / 8)  // Pior caso (escape)
+#define ARCHIVE_ORDER_LPC 0x80          // Bit da ordem que indica preditor LPC
+// Aquecimento + média, deslocamento e coeficientes do LPC
+#define ARCHIVE_PREDICTOR_MAX_BYTES (2 * ARCHIVE_LPC_ORDER + 3 + 2 * ARCHIVE_LPC_ORDER)
+#define ARCHIVE_MAX_BLOCK_SIZE (ARCHIVE_HEADER_SIZE + ARCHIVE_PREDICTOR_MAX_BYTES + ARCHIVE_PARTITIONS + \
+                                ARCHIVE_BLOCK_SAMPLES * ARCHIVE_MAX_BYTES_PER_SAMPLE + 1)
+
+// Cabeçalho de um bloco: cada bloco é decodificável de forma independente
+typedef struct {
+    struct timespec start;          // Instante do primeiro frame (CLOCK_REALTIME)
+    uint32_t duration_us;           // Do primeiro ao último frame do bloco
+    int sample_count;               // Amostras no bloco
+    int order;                      // Ordem do preditor
+    int lpc;                        // 1 = LPC adaptativo, 0 = polinomial fixo
+    size_t block_size;              // Cabeçalho + payload (bytes)
+} archive_block_info_t;
+
+typedef struct {
+    int fd;
+    uint8_t *block;                 // Bloco codificado lido do arquivo
+    int16_t *samples;               // Amostras decodificadas do bloco atual
+    int position;                   // Próxima amostra a entregar
+    archive_block_info_t info;
+} archive_reader_t;
+
+size_t archive_block_max_size(int sample_count);
+
+size_t archive_encode_block(const int16_t *samples, int count, const struct timespec *start,
+                            uint32_t duration_us, uint8_t *out, size_t out_size);
+
+int archive_decode_block(const uint8_t *in, size_t in_size, int16_t *samples, int max_samples,
+                         archive_block_info_t *info);
+
+size_t archive_writer_arena_size(void);
+
+int archive_writer_init(const char *path);
+
+void archive_writer_push(const adc_frame_t *frame, const struct timespec *timestamp);
+
+void archive_writer_stop(void);
+
+size_t archive_reader_arena_size(void);
+
+int archive_reader_open(archive_reader_t *reader, const char *path);
+
+int archive_reader_next_frame(archive_reader_t *reader, adc_frame_t *frame, struct timespec *timestamp);
+
+void archive_reader_close(archive_reader_t *reader);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,21 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_ALIGN_UP(size) (((size) + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1))
+
+int arena_init(size_t size);
+
+void *arena_alloc(size_t size);
+
+void arena_seal(void);
+
+size_t arena_used(void);
+
+size_t arena_capacity(void);
+
+void arena_cleanup(void);
+
+#endif // ARENA_H
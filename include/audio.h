@@ -1,12 +1,33 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+size_t audio_arena_size(void);
+
+int audio_init(void);
+
 float audio_calculate_dbfs(float rms);
 
 float audio_normalize_rms(float rms);
 
 int audio_calculate_bar_length(float normalized);
 
+int32_t audio_calculate_dbfs_fixed(int64_t sum_squares);
+
+int audio_calculate_bar_length_fixed(int64_t sum_squares);
+
+int32_t audio_ratio_db_fixed(uint64_t num, uint64_t den);
+
+void audio_format_db(char *buffer, size_t size, int32_t db_q8);
+
+void audio_format_volts(char *buffer, size_t size, uint32_t counts_q4);
+
 void audio_print_bar(float rms, float dbfs);
 
-#endif // AUDIO_H
\ No newline at end of file
+void audio_print_bar_length(int barLength, float rms, float dbfs);
+
+void audio_print_bar_fixed(int barLength, uint32_t rms_q4, int32_t dbfs_q8);
+
+#endif // AUDIO_H
@@ -8,6 +8,7 @@
 #define ADS1115_ADDR 0x48
 #define CONVERSION_DELAY 4000   // 4ms para conversão a 250 SPS
 #define NUM_SAMPLES 4
+#define ADC_FULL_SCALE 2.048f   // Faixa do PGA (±2.048V)
 
 #define ADS1115_CONFIG 0b1100010110100011
 
@@ -17,12 +18,49 @@
 #define LCD_ENABLE    0x04
 #define LCD_CMD       0
 #define LCD_CHR       1
+#define LCD_COLS      16
+
+// LCD Meter Configuration (modo medidor com caracteres CGRAM)
+#define LCD_METER_STEPS (LCD_COLS * 5)   // 5 colunas de pixels por célula = 80 passos
+#define LCD_METER_FPS 15                 // Taxa de atualização do medidor
+#define LCD_METER_MAX_BYTES 6            // Orçamento de bytes enviados ao LCD por quadro
 
 // Audio Processing Configuration
 #define BAR_WIDTH 80
 #define MAX_RMS 0.707f
 #define DC_OFFSET 1.25f
 #define MIN_NORMALIZED 0.001f
+#define MIN_RMS 0.0001f                 // RMS mínimo considerado no cálculo de dBFS
+
+// Caminho de ponto fixo (sem logf e sem float no processamento por frame)
+#ifndef AUDIO_FIXED_POINT
+#define AUDIO_FIXED_POINT 0
+#endif
+#define AUDIO_DB_FRAC_BITS 8            // dBFS em ponto fixo Q8 (1/256 dB)
+#define DC_OFFSET_COUNTS ((int32_t)(DC_OFFSET * 32768.0f / ADC_FULL_SCALE + 0.5f))
+
+// Peak Detection Configuration
+#define PEAK_TRUE_PEAK 1               // Habilita o pico interpolado (true-peak)
+#define PEAK_OVERSAMPLE 4              // Fator de sobreamostragem do true-peak
+#define PEAK_HOLD_FRAMES 30            // Frames de retenção do pico (~1 s a 30 FPS)
+#define PEAK_HOLD_DECAY_DB_S 20.0f     // Decaimento do peak-hold após a retenção (dB/s)
+#define PEAK_CREST_LIMIT_DB 20.0f      // Razão pico/RMS de fundo para evento impulsivo (dB)
+#define PEAK_BACKGROUND_ALPHA 0.05f    // Constante da média exponencial do RMS de fundo
+#define PEAK_MIN_BACKGROUND 0.001f     // RMS de fundo mínimo (V) para evitar falsos eventos
+#define PEAK_EVENT_REFRACTORY 10       // Frames ignorados após um evento impulsivo
+
+// Archive Configuration (áudio bruto comprimido sem perdas)
+#define ARCHIVE_BLOCK_FRAMES 256        // Frames de aquisição por bloco (~8.5 s a 30 FPS)
+#define ARCHIVE_RING_BLOCKS 4           // Blocos no buffer circular do gravador
+#define ARCHIVE_PARTITIONS 4            // Partições Rice por bloco
+#define ARCHIVE_MAX_ORDER 3             // Ordem máxima do preditor polinomial
+#define ARCHIVE_LPC_ORDER 8             // Ordem máxima do preditor LPC adaptativo
+#define ARCHIVE_LPC_PRECISION 12        // Bits (com sinal) dos coeficientes LPC quantizados
+#define ARCHIVE_RICE_LIMIT 32           // Prefixo unário máximo antes do escape
+
+// Threads auxiliares (LCD e gravador): o mlockall de arena_seal() trava a
+// pilha inteira em RAM, então o padrão de 8 MiB é reduzido
+#define THREAD_STACK_SIZE (64 * 1024)
 
 // Timing Configuration
 #define TARGET_INTERVAL_NS 33330000  // Intervalo de tempo de ~33.33ms em nanosegundos (30 FPS)
@@ -1,16 +1,34 @@
 #ifndef LCD_H
 #define LCD_H
 
+#include <stddef.h>
 #include <stdint.h>
 
-void lcd_init(void);
+int lcd_init(void);
+
+// Retorna o modo efetivo: 0 se o medidor não pôde ser iniciado
+int lcd_init_async(int meter_mode);
+
+int lcd_is_ready(void);
+
+int lcd_has_failed(void);
+
+void lcd_stop(void);
 
 void lcd_write(const char *line1, const char *line2);
 
+size_t lcd_arena_size(void);
+
+int lcd_meter_init(void);
+
+void lcd_meter_update(int level_steps, int peak_steps);
+
+void lcd_meter_set_text(const char *line2);
+
 void lcd_send_byte(uint8_t bits, int mode);
 
 void lcd_toggle_enable(uint8_t bits);
 
 void lcd_cleanup(void);
 
-#endif // LCD_H
\ No newline at end of file
+#endif // LCD_H
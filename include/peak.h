@@ -0,0 +1,48 @@
+#ifndef PEAK_H
+#define PEAK_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "adc.h"
+
+// Evento impulsivo (batida de porta, queda de objeto, ...)
+typedef struct {
+    struct timespec timestamp;    // Instante do evento (CLOCK_REALTIME)
+    int32_t peak;                 // Pico do frame (contagens)
+    uint32_t background_q4;       // RMS de fundo no momento do evento (contagens Q4)
+    int32_t ratio_db;             // Razão pico/RMS de fundo (dB Q8)
+} peak_event_t;
+
+// Estado inteiro (contagens do ADC), igual nos caminhos flutuante e fixo
+typedef struct {
+    int32_t hold;                 // Peak-hold atual (contagens)
+    int hold_frames;              // Frames restantes de retenção
+    int32_t decay_factor;         // Fator de decaimento por frame (Q16)
+    int32_t background;           // RMS de fundo (média exponencial, contagens Q12)
+    int32_t min_background;       // Piso do RMS de fundo (contagens Q12)
+    int32_t window_peak;          // Maior pico da janela de média (contagens)
+    uint64_t window_power;        // Soma de rms_q4^2 dos frames da janela
+    int window_frames;            // Frames acumulados na janela
+    int32_t crest_limit;          // Razão linear pico/RMS de fundo para evento (Q8)
+    int refractory;               // Frames restantes sem detecção
+    int warmup;                   // Frames restantes de convergência do fundo
+    int event_count;              // Eventos detectados desde o último reset
+} peak_tracker_t;
+
+void peak_init(peak_tracker_t *tracker, float crest_limit_db);
+
+int peak_update(peak_tracker_t *tracker, const adc_frame_t *frame, peak_event_t *event);
+
+// Soma dos quadrados equivalente ao peak-hold (senóide), para dBFS e barra
+int64_t peak_hold_sum_squares(const peak_tracker_t *tracker);
+
+// Fator de crista da janela (maior pico / RMS da janela inteira), em dB Q8
+int32_t peak_crest_db(const peak_tracker_t *tracker);
+
+// Zera as estatísticas da janela de média (pico, potência e eventos)
+void peak_reset_window(peak_tracker_t *tracker);
+
+void peak_print_event(const peak_event_t *event);
+
+#endif // PEAK_H
@@ -6,6 +6,62 @@
 #include "adc.h"
 #include "config.h"
 
+#if PEAK_TRUE_PEAK
+// A interpolação fica restrita às amostras do próprio frame: entre frames há
+// um intervalo de ~21 ms sem amostras, e a curva atravessando-o inflaria o pico.
+// Nos segmentos das bordas o vizinho ausente é substituído pela amostra da borda.
+#define TP_CLAMP(i) ((i) < 0 ? 0 : ((i) > NUM_SAMPLES - 1 ? NUM_SAMPLES - 1 : (i)))
+
+// Máximo |x| dos pontos interpolados (Catmull-Rom) entre p1 e p2
+static float true_peak_segment(float p0, float p1, float p2, float p3) {
+    float max_abs = 0.0f;
+    for (int k = 1; k < PEAK_OVERSAMPLE; k++) {
+        float t = (float)k / PEAK_OVERSAMPLE;
+        float t2 = t * t;
+        float t3 = t2 * t;
+        float y = 0.5f * ((2.0f * p1) +
+                          (-p0 + p2) * t +
+                          (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                          (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+        max_abs = fmaxf(max_abs, fabsf(y));
+    }
+    return max_abs;
+}
+
+// Versão inteira: pesos de Catmull-Rom escalados por 2*N^3 (exatos para t = k/N)
+static int32_t true_peak_segment_fixed(int32_t p0, int32_t p1, int32_t p2, int32_t p3) {
+    const int32_t n = PEAK_OVERSAMPLE;
+    const int32_t scale = 2 * n * n * n;
+    int32_t max_abs = 0;
+    for (int32_t k = 1; k < n; k++) {
+        int64_t w0 = -k * n * n + 2 * k * k * n - k * k * k;
+        int64_t w1 = 2 * n * n * n - 5 * k * k * n + 3 * k * k * k;
+        int64_t w2 = k * n * n + 4 * k * k * n - 3 * k * k * k;
+        int64_t w3 = -k * k * n + k * k * k;
+        int32_t y = (int32_t)((w0 * p0 + w1 * p1 + w2 * p2 + w3 * p3) / scale);
+        int32_t mag = (y < 0) ? -y : y;
+        max_abs = (mag > max_abs) ? mag : max_abs;
+    }
+    return max_abs;
+}
+#endif
+
+// Raiz quadrada inteira (floor) dígito a dígito, a partir do bit mais alto de x
+static uint32_t isqrt64(uint64_t x) {
+    if (x == 0) return 0;
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << ((63 - __builtin_clzll(x)) & ~1);
+    while (bit != 0) {
+        // Sem desvios: mask = ~0 quando o dígito é 1
+        uint64_t trial = result + bit;
+        uint64_t mask = -(uint64_t)(x >= trial);
+        x -= trial & mask;
+        result = (result >> 1) + (bit & mask);
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
 int16_t swap_bytes(int16_t val) {
     return (val << 8) | ((val >> 8) & 0xFF);   
 }
@@ -28,27 +84,112 @@ int16_t adc_read_sample(int handle) {
     return swap_bytes(value);
 }
 
-float adc_calculate_rms(int handle) {
+void adc_read_frame(int handle, adc_frame_t *frame) {
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        frame->samples[i] = adc_read_sample(handle);
+    }
+    adc_process_frame(frame);
+}
+
+void adc_process_frame(adc_frame_t *frame) {
+#if AUDIO_FIXED_POINT
+    adc_process_frame_fixed(frame);
+#else
+    adc_process_frame_float(frame);
+#endif
+}
+
+void adc_process_frame_float(adc_frame_t *frame) {
     // Pré-calculando constantes para otimização
-    const float voltage_scale = 2.048f / 32768.0f;
+    const float voltage_scale = ADC_FULL_SCALE / 32768.0f;
+    const float counts_scale = 32768.0f / ADC_FULL_SCALE;
     const float samples_inv = 1.0f / NUM_SAMPLES;
     
     float sumSquares = 0.0f;
+    float peak = 0.0f;
+    float true_peak = 0.0f;
+#if PEAK_TRUE_PEAK
+    float ac[NUM_SAMPLES];
+#endif
 
+    // Passada única: soma dos quadrados e max-abs sem desvios (vetorizável)
     for (int i = 0; i < NUM_SAMPLES; i++) {
-        int16_t value = adc_read_sample(handle);
-        
         // Calcula o valor da tensão do sinal
-        float voltage = value * voltage_scale;
+        float voltage = frame->samples[i] * voltage_scale;
         // Remove o offset DC do MAX9814
         float ac_voltage = voltage - DC_OFFSET;
         // Soma os quadrados das tensões amostradas para cálculo do RMS
         sumSquares += ac_voltage * ac_voltage;
+        // Pico amostral
+        peak = fmaxf(peak, fabsf(ac_voltage));
 
-        // Teste (comentado)
-        // printf("Raw: %6d | V: %1.3f | AC: %1.3f\n", value, voltage, ac_voltage);
+#if PEAK_TRUE_PEAK
+        ac[i] = ac_voltage;
+#endif
     }
 
+#if PEAK_TRUE_PEAK
+    // Pico interpolado entre amostras consecutivas do frame
+    for (int i = 0; i < NUM_SAMPLES - 1; i++) {
+        true_peak = fmaxf(true_peak, true_peak_segment(ac[TP_CLAMP(i - 1)], ac[i],
+                                                       ac[i + 1], ac[TP_CLAMP(i + 2)]));
+    }
+#endif
+
     // Calcula o valor RMS do sinal
-    return sqrtf(sumSquares * samples_inv);
-}
\ No newline at end of file
+    frame->rms = sqrtf(sumSquares * samples_inv);
+    frame->peak = peak;
+    frame->true_peak = fmaxf(true_peak, peak);
+
+    // Métricas em contagens para o rastreador de pico (inteiro nos dois caminhos)
+    frame->rms_q4 = (uint32_t)(frame->rms * counts_scale * 16.0f + 0.5f);
+    frame->true_peak_counts = (int32_t)(frame->true_peak * counts_scale + 0.5f);
+}
+
+void adc_process_frame_fixed(adc_frame_t *frame) {
+    // Sem conversão para volts: dBFS, barra, rastreador de pico e exibição
+    // trabalham direto nas contagens
+    int64_t sum_squares = 0;
+    int32_t peak = 0;
+    int32_t true_peak = 0;
+#if PEAK_TRUE_PEAK
+    int32_t ac_frame[NUM_SAMPLES];
+#endif
+
+    // Passada única inteira: quadrados de int16 acumulados em int64
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        int32_t ac = frame->samples[i] - DC_OFFSET_COUNTS;
+        sum_squares += (int64_t)ac * ac;
+        int32_t mag = (ac < 0) ? -ac : ac;
+        peak = (mag > peak) ? mag : peak;
+
+#if PEAK_TRUE_PEAK
+        ac_frame[i] = ac;
+#endif
+    }
+
+#if PEAK_TRUE_PEAK
+    for (int i = 0; i < NUM_SAMPLES - 1; i++) {
+        int32_t tp = true_peak_segment_fixed(ac_frame[TP_CLAMP(i - 1)], ac_frame[i],
+                                             ac_frame[i + 1], ac_frame[TP_CLAMP(i + 2)]);
+        true_peak = (tp > true_peak) ? tp : true_peak;
+    }
+#endif
+
+    // RMS em contagens Q4 (resolução de 1/16 de contagem)
+    uint32_t rms_q4 = isqrt64(((uint64_t)sum_squares << 8) / NUM_SAMPLES);
+
+    frame->sum_squares = sum_squares;
+    frame->rms_q4 = rms_q4;
+    frame->true_peak_counts = (true_peak > peak) ? true_peak : peak;
+}
+
+float adc_calculate_rms(int handle) {
+    adc_frame_t frame;
+    adc_read_frame(handle, &frame);
+#if AUDIO_FIXED_POINT
+    // Os campos em volts só existem no caminho de ponto flutuante
+    adc_process_frame_float(&frame);
+#endif
+    return frame.rms;
+}
@@ -0,0 +1,688 @@
+#include "archive.h"
+#include "arena.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+#define ARCHIVE_RING_FRAMES (ARCHIVE_BLOCK_FRAMES * ARCHIVE_RING_BLOCKS)
+
+// Frame guardado no buffer circular entre a aquisição e o gravador
+typedef struct {
+    struct timespec timestamp;
+    int16_t samples[NUM_SAMPLES];
+} archive_frame_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t pos;
+    uint64_t acc;
+    int bits;
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t size;
+    size_t pos;
+    uint64_t acc;
+    int bits;
+    int error;
+} bit_reader_t;
+
+// Estado do gravador em segundo plano
+static archive_frame_t *ring = NULL;
+static atomic_uint ring_head = 0;           // Escrito só pela aquisição
+static atomic_uint ring_tail = 0;           // Escrito só pelo gravador
+static atomic_uint frames_dropped = 0;
+static atomic_int writer_running = 0;
+static int16_t *writer_samples = NULL;
+static uint8_t *writer_block = NULL;
+static int writer_fd = -1;
+static int writer_error = 0;
+static pthread_t writer_thread;
+static sem_t writer_sem;
+static unsigned long long blocks_written = 0;
+static unsigned long long raw_bytes = 0;
+static unsigned long long compressed_bytes = 0;
+
+// ============================================================================
+// Codec: preditor (polinomial fixo ou LPC adaptativo) + código de Rice particionado
+// ============================================================================
+
+// Preditor de um bloco: polinomial de ordem 0-3 ou LPC com coeficientes quantizados
+typedef struct {
+    int order;                              // Amostras de aquecimento
+    int lpc;                                // 1 = LPC, 0 = polinomial fixo
+    int shift;                              // Bits fracionários dos coeficientes
+    int32_t mean;                           // Média do bloco (o LPC prediz em torno dela)
+    int32_t coeffs[ARCHIVE_LPC_ORDER];      // coeffs[k] multiplica a amostra j - 1 - k
+} predictor_t;
+
+static void put_le(uint8_t *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static void bw_put(bit_writer_t *bw, uint32_t value, int nbits) {
+    if (nbits == 0) return;
+    bw->acc = (bw->acc << nbits) | (value & ((1ULL << nbits) - 1));
+    bw->bits += nbits;
+    while (bw->bits >= 8) {
+        bw->bits -= 8;
+        if (bw->pos < bw->size) {
+            bw->buf[bw->pos] = (uint8_t)(bw->acc >> bw->bits);
+        }
+        bw->pos++;
+    }
+}
+
+static void bw_flush(bit_writer_t *bw) {
+    if (bw->bits > 0) {
+        bw_put(bw, 0, 8 - bw->bits);
+    }
+}
+
+static uint32_t br_get(bit_reader_t *br, int nbits) {
+    if (nbits == 0) return 0;
+    while (br->bits < nbits) {
+        if (br->pos >= br->size) {
+            br->error = 1;
+            return 0;
+        }
+        br->acc = (br->acc << 8) | br->buf[br->pos++];
+        br->bits += 8;
+    }
+    br->bits -= nbits;
+    return (uint32_t)(br->acc >> br->bits) & (uint32_t)((1ULL << nbits) - 1);
+}
+
+static int32_t predict(const predictor_t *p, const int16_t *s, int j) {
+    if (p->lpc) {
+        int64_t acc = 0;
+        for (int k = 0; k < p->order; k++) {
+            acc += (int64_t)p->coeffs[k] * (s[j - 1 - k] - p->mean);
+        }
+        // Soma sem sinal: coeficientes corrompidos não causam overflow com sinal
+        return (int32_t)((uint32_t)p->mean + (uint32_t)(acc >> p->shift));
+    }
+    switch (p->order) {
+    case 1:  return s[j - 1];
+    case 2:  return 2 * s[j - 1] - s[j - 2];
+    case 3:  return 3 * s[j - 1] - 3 * s[j - 2] + s[j - 3];
+    default: return 0;
+    }
+}
+
+static uint32_t zigzag(int32_t r) {
+    return ((uint32_t)r << 1) ^ (uint32_t)(r >> 31);
+}
+
+static int32_t unzigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static int partition_count(int residuals) {
+    return (residuals >= ARCHIVE_PARTITIONS) ? ARCHIVE_PARTITIONS : 1;
+}
+
+// Soma de |resíduo| a partir de start (mesmo início para todos os candidatos)
+static uint64_t predictor_cost(const predictor_t *p, const int16_t *s, int start, int count) {
+    uint64_t cost = 0;
+    for (int j = start; j < count; j++) {
+        int32_t r = s[j] - predict(p, s, j);
+        cost += (uint32_t)(r < 0 ? -r : r);
+    }
+    return cost;
+}
+
+// Quantiza os coeficientes com ARCHIVE_LPC_PRECISION bits, propagando o erro de
+// arredondamento para o coeficiente seguinte. Retorna 0 se não couberem
+static int lpc_quantize(const double *a, int order, int32_t mean, predictor_t *p) {
+    const int32_t limit = (1 << (ARCHIVE_LPC_PRECISION - 1)) - 1;
+    double cmax = 0.0;
+    for (int k = 1; k <= order; k++) {
+        cmax = fmax(cmax, fabs(a[k]));
+    }
+
+    int exponent = 0;
+    if (cmax > 0.0) frexp(cmax, &exponent);     // cmax < 2^exponent
+    int shift = ARCHIVE_LPC_PRECISION - 1 - exponent;
+    if (shift < 0) return 0;
+    if (shift > 15) shift = 15;
+
+    double error = 0.0;
+    for (int k = 0; k < order; k++) {
+        double value = a[k + 1] * (1 << shift) + error;
+        long q = lround(value);
+        if (q > limit) q = limit;
+        if (q < -limit - 1) q = -limit - 1;
+        error = value - q;
+        p->coeffs[k] = (int32_t)q;
+    }
+    p->order = order;
+    p->lpc = 1;
+    p->shift = shift;
+    p->mean = mean;
+    return 1;
+}
+
+// LPC por Levinson-Durbin sobre a autocorrelação do bloco sem a média. Preenche
+// candidates[i - 1] com o preditor de ordem i e retorna a maior ordem obtida
+static int lpc_compute(const int16_t *s, int count, predictor_t *candidates) {
+    double r[ARCHIVE_LPC_ORDER + 1];
+    double a[ARCHIVE_LPC_ORDER + 1] = {0};
+    double prev[ARCHIVE_LPC_ORDER + 1];
+
+    int64_t sum = 0;
+    for (int j = 0; j < count; j++) sum += s[j];
+    int32_t mean = (int32_t)((sum + (sum >= 0 ? count / 2 : -count / 2)) / count);
+
+    for (int lag = 0; lag <= ARCHIVE_LPC_ORDER; lag++) {
+        double acc = 0.0;
+        for (int j = lag; j < count; j++) {
+            acc += (double)(s[j] - mean) * (s[j - lag] - mean);
+        }
+        r[lag] = acc;
+    }
+    if (r[0] <= 0.0) return 0;    // Bloco constante: o polinomial de ordem 1 é exato
+
+    double error = r[0];
+    int orders = 0;
+    for (int i = 1; i <= ARCHIVE_LPC_ORDER; i++) {
+        double acc = r[i];
+        for (int j = 1; j < i; j++) acc -= a[j] * r[i - j];
+        double k = acc / error;
+
+        memcpy(prev, a, sizeof(a));
+        a[i] = k;
+        for (int j = 1; j < i; j++) a[j] = prev[j] - k * prev[i - j];
+        error *= 1.0 - k * k;
+
+        if (!lpc_quantize(a, i, mean, &candidates[i - 1])) break;
+        orders = i;
+        if (error <= 0.0) break;
+    }
+    return orders;
+}
+
+size_t archive_block_max_size(int sample_count) {
+    // Pior caso: escape em todas as amostras
+    return ARCHIVE_HEADER_SIZE + ARCHIVE_PREDICTOR_MAX_BYTES + ARCHIVE_PARTITIONS +
+           (size_t)sample_count * ARCHIVE_MAX_BYTES_PER_SAMPLE + 1;
+}
+
+size_t archive_encode_block(const int16_t *samples, int count, const struct timespec *start,
+                            uint32_t duration_us, uint8_t *out, size_t out_size) {
+    if (count <= 0 || count > 0xFFFF || out_size < archive_block_max_size(count)) return 0;
+
+    // Escolhe o preditor com menor soma de |resíduo|: polinomiais fixos 0-3 e
+    // LPC de ordem 1 a ARCHIVE_LPC_ORDER calculado para o próprio bloco
+    int cost_start = (count > ARCHIVE_LPC_ORDER) ? ARCHIVE_LPC_ORDER : count;
+    predictor_t best = {0};
+    uint64_t best_cost = predictor_cost(&best, samples, cost_start, count);
+
+    for (int o = 1; o <= ARCHIVE_MAX_ORDER && o <= count; o++) {
+        predictor_t fixed = {.order = o};
+        uint64_t cost = predictor_cost(&fixed, samples, cost_start, count);
+        if (cost < best_cost) {
+            best = fixed;
+            best_cost = cost;
+        }
+    }
+
+    predictor_t lpc[ARCHIVE_LPC_ORDER];
+    int lpc_orders = (count > 2 * ARCHIVE_LPC_ORDER) ? lpc_compute(samples, count, lpc) : 0;
+    for (int o = 0; o < lpc_orders; o++) {
+        uint64_t cost = predictor_cost(&lpc[o], samples, cost_start, count);
+        if (cost < best_cost) {
+            best = lpc[o];
+            best_cost = cost;
+        }
+    }
+    int order = best.order;
+
+    // Cabeçalho (o tamanho do payload é preenchido no final)
+    put_le(out + 0, ARCHIVE_MAGIC, 4);
+    put_le(out + 8, (uint64_t)start->tv_sec, 8);
+    put_le(out + 16, (uint32_t)start->tv_nsec, 4);
+    put_le(out + 20, duration_us, 4);
+    put_le(out + 24, (uint16_t)count, 2);
+    out[26] = (uint8_t)(order | (best.lpc ? ARCHIVE_ORDER_LPC : 0));
+    out[27] = (uint8_t)partition_count(count - order);
+
+    // Amostras de aquecimento do preditor, sem compressão
+    size_t pos = ARCHIVE_HEADER_SIZE;
+    for (int i = 0; i < order; i++) {
+        put_le(out + pos, (uint16_t)samples[i], 2);
+        pos += 2;
+    }
+
+    // Parâmetros do LPC: média, deslocamento e coeficientes
+    if (best.lpc) {
+        put_le(out + pos, (uint16_t)best.mean, 2);
+        out[pos + 2] = (uint8_t)best.shift;
+        pos += 3;
+        for (int k = 0; k < order; k++) {
+            put_le(out + pos, (uint16_t)best.coeffs[k], 2);
+            pos += 2;
+        }
+    }
+
+    bit_writer_t bw = {out + pos, out_size - pos, 0, 0, 0};
+    int residuals = count - order;
+    int partitions = partition_count(residuals);
+    int per_partition = residuals / partitions;
+
+    int i = order;
+    for (int p = 0; p < partitions; p++) {
+        int n = (p == partitions - 1) ? residuals - per_partition * (partitions - 1) : per_partition;
+
+        // Parâmetro de Rice a partir da média dos resíduos da partição
+        uint64_t sum = 0;
+        for (int j = i; j < i + n; j++) {
+            sum += zigzag(samples[j] - predict(&best, samples, j));
+        }
+        int k = 0;
+        while (k < 30 && ((uint64_t)n << (k + 1)) < sum) k++;
+        bw_put(&bw, (uint32_t)k, 5);
+
+        for (int j = i; j < i + n; j++) {
+            uint32_t u = zigzag(samples[j] - predict(&best, samples, j));
+            uint32_t q = u >> k;
+            if (q < ARCHIVE_RICE_LIMIT) {
+                bw_put(&bw, (uint32_t)(((1ULL << q) - 1) << 1), (int)q + 1);
+                bw_put(&bw, u, k);
+            } else {
+                // Escape: prefixo máximo seguido do valor bruto
+                bw_put(&bw, (uint32_t)((1ULL << ARCHIVE_RICE_LIMIT) - 1), ARCHIVE_RICE_LIMIT);
+                bw_put(&bw, u, 32);
+            }
+        }
+        i += n;
+    }
+    bw_flush(&bw);
+
+    size_t payload = (pos - ARCHIVE_HEADER_SIZE) + bw.pos;
+    if (payload > (size_t)count * sizeof(int16_t)) {
+        // Sinal imprevisível (ruído de fundo de escala): guarda sem compressão
+        out[26] = 0;
+        out[27] = 0;
+        for (int j = 0; j < count; j++) {
+            put_le(out + ARCHIVE_HEADER_SIZE + 2 * j, (uint16_t)samples[j], 2);
+        }
+        payload = (size_t)count * sizeof(int16_t);
+    }
+    put_le(out + 4, (uint32_t)payload, 4);
+    return ARCHIVE_HEADER_SIZE + payload;
+}
+
+int archive_decode_block(const uint8_t *in, size_t in_size, int16_t *samples, int max_samples,
+                         archive_block_info_t *info) {
+    if (in_size < ARCHIVE_HEADER_SIZE || get_le(in, 4) != ARCHIVE_MAGIC) return -1;
+
+    size_t payload = get_le(in + 4, 4);
+    int count = (int)get_le(in + 24, 2);
+    int lpc = (in[26] & ARCHIVE_ORDER_LPC) != 0;
+    int order = in[26] & ~ARCHIVE_ORDER_LPC;
+    int partitions = in[27];
+    int verbatim = (partitions == 0);
+    if (payload > in_size - ARCHIVE_HEADER_SIZE || count > max_samples ||
+        order > (lpc ? ARCHIVE_LPC_ORDER : ARCHIVE_MAX_ORDER) || order > count ||
+        (!verbatim && partitions != partition_count(count - order))) {
+        return -1;
+    }
+
+    info->start.tv_sec = (time_t)get_le(in + 8, 8);
+    info->start.tv_nsec = (long)get_le(in + 16, 4);
+    info->duration_us = (uint32_t)get_le(in + 20, 4);
+    info->sample_count = count;
+    info->order = order;
+    info->lpc = lpc;
+    info->block_size = ARCHIVE_HEADER_SIZE + payload;
+
+    size_t pos = ARCHIVE_HEADER_SIZE;
+    if (verbatim) {
+        if (payload < (size_t)count * 2) return -1;
+        for (int i = 0; i < count; i++) {
+            samples[i] = (int16_t)get_le(in + pos + 2 * i, 2);
+        }
+        return count;
+    }
+
+    size_t params = (size_t)order * 2 + (lpc ? 3 + (size_t)order * 2 : 0);
+    if (payload < params) return -1;
+    for (int i = 0; i < order; i++) {
+        samples[i] = (int16_t)get_le(in + pos, 2);
+        pos += 2;
+    }
+
+    predictor_t predictor = {.order = order, .lpc = lpc};
+    if (lpc) {
+        predictor.mean = (int16_t)get_le(in + pos, 2);
+        predictor.shift = in[pos + 2];
+        pos += 3;
+        if (predictor.shift > 15) return -1;
+        for (int k = 0; k < order; k++) {
+            predictor.coeffs[k] = (int16_t)get_le(in + pos, 2);
+            pos += 2;
+        }
+    }
+
+    bit_reader_t br = {in + pos, ARCHIVE_HEADER_SIZE + payload - pos, 0, 0, 0, 0};
+    int residuals = count - order;
+    int per_partition = residuals / partitions;
+
+    int i = order;
+    for (int p = 0; p < partitions; p++) {
+        int n = (p == partitions - 1) ? residuals - per_partition * (partitions - 1) : per_partition;
+        int k = (int)br_get(&br, 5);
+
+        for (int j = i; j < i + n; j++) {
+            uint32_t q = 0;
+            while (q < ARCHIVE_RICE_LIMIT && br_get(&br, 1)) q++;
+            uint32_t u = (q < ARCHIVE_RICE_LIMIT) ? (q << k) | br_get(&br, k) : br_get(&br, 32);
+            if (br.error) return -1;
+
+            // Soma sem sinal: blocos corrompidos não causam overflow com sinal
+            samples[j] = (int16_t)(uint16_t)((uint32_t)unzigzag(u) + (uint32_t)predict(&predictor, samples, j));
+        }
+        i += n;
+    }
+    return count;
+}
+
+// ============================================================================
+// Gravador em segundo plano (memória limitada, nunca bloqueia a aquisição)
+// ============================================================================
+
+static void archive_write_block(unsigned int frames) {
+    unsigned int tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    const archive_frame_t *first = &ring[tail % ARCHIVE_RING_FRAMES];
+    const archive_frame_t *last = &ring[(tail + frames - 1) % ARCHIVE_RING_FRAMES];
+
+    for (unsigned int f = 0; f < frames; f++) {
+        memcpy(writer_samples + f * NUM_SAMPLES, ring[(tail + f) % ARCHIVE_RING_FRAMES].samples,
+               sizeof(ring[0].samples));
+    }
+
+    long long duration_ns = (last->timestamp.tv_sec - first->timestamp.tv_sec) * 1000000000LL +
+                            (last->timestamp.tv_nsec - first->timestamp.tv_nsec);
+    struct timespec start = first->timestamp;
+
+    // Libera o espaço no buffer circular antes da compressão e da escrita
+    atomic_store_explicit(&ring_tail, tail + frames, memory_order_release);
+
+    int count = (int)frames * NUM_SAMPLES;
+    size_t size = archive_encode_block(writer_samples, count, &start,
+                                       (uint32_t)(duration_ns > 0 ? duration_ns / 1000 : 0),
+                                       writer_block, archive_block_max_size(ARCHIVE_BLOCK_SAMPLES));
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = write(writer_fd, writer_block + written, size - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) {
+            if (!writer_error) {
+                fprintf(stderr, "Erro ao gravar o arquivo de áudio: %s\n", strerror(errno));
+                writer_error = 1;
+            }
+            return;
+        }
+        written += (size_t)result;
+    }
+
+    blocks_written++;
+    raw_bytes += (unsigned long long)count * sizeof(int16_t);
+    compressed_bytes += size;
+}
+
+static void *archive_writer_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        while (sem_wait(&writer_sem) != 0 && errno == EINTR) {}
+        int stopping = !atomic_load(&writer_running);
+
+        unsigned int head = atomic_load_explicit(&ring_head, memory_order_acquire);
+        while (head - atomic_load_explicit(&ring_tail, memory_order_relaxed) >= ARCHIVE_BLOCK_FRAMES) {
+            archive_write_block(ARCHIVE_BLOCK_FRAMES);
+        }
+
+        if (stopping) {
+            // Bloco final parcial
+            unsigned int pending = head - atomic_load_explicit(&ring_tail, memory_order_relaxed);
+            if (pending > 0) archive_write_block(pending);
+            break;
+        }
+    }
+    return NULL;
+}
+
+size_t archive_writer_arena_size(void) {
+    return ARENA_ALIGN_UP(sizeof(archive_frame_t) * ARCHIVE_RING_FRAMES) +
+           ARENA_ALIGN_UP(sizeof(int16_t) * ARCHIVE_BLOCK_SAMPLES) +
+           ARENA_ALIGN_UP(archive_block_max_size(ARCHIVE_BLOCK_SAMPLES));
+}
+
+int archive_writer_init(const char *path) {
+    ring = arena_alloc(sizeof(archive_frame_t) * ARCHIVE_RING_FRAMES);
+    writer_samples = arena_alloc(sizeof(int16_t) * ARCHIVE_BLOCK_SAMPLES);
+    writer_block = arena_alloc(archive_block_max_size(ARCHIVE_BLOCK_SAMPLES));
+    if (ring == NULL || writer_samples == NULL || writer_block == NULL) {
+        return -1;
+    }
+
+    writer_fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (writer_fd < 0) {
+        fprintf(stderr, "Erro ao abrir o arquivo de áudio '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    sem_init(&writer_sem, 0, 0);
+    atomic_store(&writer_running, 1);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, THREAD_STACK_SIZE);
+    int created = pthread_create(&writer_thread, &attr, archive_writer_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (created != 0) {
+        fprintf(stderr, "Erro ao criar a thread do gravador de áudio.\n");
+        atomic_store(&writer_running, 0);
+        close(writer_fd);
+        writer_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void archive_writer_push(const adc_frame_t *frame, const struct timespec *timestamp) {
+    unsigned int head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+
+    // Buffer cheio: descarta em vez de esperar pelo cartão SD
+    if (head - tail >= ARCHIVE_RING_FRAMES) {
+        atomic_fetch_add_explicit(&frames_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    archive_frame_t *slot = &ring[head % ARCHIVE_RING_FRAMES];
+    slot->timestamp = *timestamp;
+    memcpy(slot->samples, frame->samples, sizeof(slot->samples));
+    atomic_store_explicit(&ring_head, head + 1, memory_order_release);
+
+    if ((head + 1) % ARCHIVE_BLOCK_FRAMES == 0) {
+        sem_post(&writer_sem);
+    }
+}
+
+void archive_writer_stop(void) {
+    if (writer_fd < 0) return;
+
+    atomic_store(&writer_running, 0);
+    sem_post(&writer_sem);
+    pthread_join(writer_thread, NULL);
+    sem_destroy(&writer_sem);
+    close(writer_fd);
+    writer_fd = -1;
+
+    printf("Arquivo de áudio: %llu blocos, %llu -> %llu bytes (%.2f:1), %u frames descartados\n",
+           blocks_written, raw_bytes, compressed_bytes,
+           compressed_bytes ? (double)raw_bytes / compressed_bytes : 0.0,
+           atomic_load(&frames_dropped));
+}
+
+// ============================================================================
+// Leitor: entrega frames decodificados para o caminho de replay
+// ============================================================================
+
+static int read_full(int fd, uint8_t *buf, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = read(fd, buf + done, size - done);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return (done == 0 && result == 0) ? 0 : -1;
+        done += (size_t)result;
+    }
+    return 1;
+}
+
+size_t archive_reader_arena_size(void) {
+    return ARENA_ALIGN_UP(archive_block_max_size(ARCHIVE_BLOCK_SAMPLES)) +
+           ARENA_ALIGN_UP(sizeof(int16_t) * ARCHIVE_BLOCK_SAMPLES);
+}
+
+int archive_reader_open(archive_reader_t *reader, const char *path) {
+    reader->block = arena_alloc(archive_block_max_size(ARCHIVE_BLOCK_SAMPLES));
+    reader->samples = arena_alloc(sizeof(int16_t) * ARCHIVE_BLOCK_SAMPLES);
+    if (reader->block == NULL || reader->samples == NULL) {
+        return -1;
+    }
+
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd < 0) {
+        fprintf(stderr, "Erro ao abrir o arquivo de áudio '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+    reader->position = 0;
+    reader->info.sample_count = 0;
+    return 0;
+}
+
+// Procura a próxima ocorrência de ARCHIVE_MAGIC a partir de 'from' e posiciona o
+// arquivo nela: 1 = encontrada, 0 = fim do arquivo, -1 = erro de leitura
+static int archive_reader_resync(archive_reader_t *reader, off_t from, off_t *found) {
+    const size_t capacity = archive_block_max_size(ARCHIVE_BLOCK_SAMPLES);
+    if (lseek(reader->fd, from, SEEK_SET) < 0) return -1;
+
+    // Janela deslizante dos últimos 4 bytes, em little-endian como no cabeçalho
+    uint32_t window = 0;
+    off_t offset = from;
+    for (;;) {
+        ssize_t count = read(reader->fd, reader->block, capacity);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) return -1;
+        if (count == 0) {
+            *found = offset;
+            return 0;
+        }
+        for (ssize_t i = 0; i < count; i++) {
+            window = (window >> 8) | ((uint32_t)reader->block[i] << 24);
+            offset++;
+            if (window == ARCHIVE_MAGIC && offset - 4 >= from) {
+                *found = offset - 4;
+                return lseek(reader->fd, *found, SEEK_SET) < 0 ? -1 : 1;
+            }
+        }
+    }
+}
+
+// Lê e decodifica o bloco na posição atual do arquivo: 1 = ok, 0 = fim do
+// arquivo, -1 = bloco inválido ou truncado
+static int archive_reader_read_block(archive_reader_t *reader) {
+    const size_t capacity = archive_block_max_size(ARCHIVE_BLOCK_SAMPLES);
+
+    int result = read_full(reader->fd, reader->block, ARCHIVE_HEADER_SIZE);
+    if (result <= 0) return result;
+
+    size_t payload = get_le(reader->block + 4, 4);
+    if (get_le(reader->block, 4) != ARCHIVE_MAGIC || payload > capacity - ARCHIVE_HEADER_SIZE ||
+        read_full(reader->fd, reader->block + ARCHIVE_HEADER_SIZE, payload) <= 0) {
+        return -1;
+    }
+    if (archive_decode_block(reader->block, ARCHIVE_HEADER_SIZE + payload, reader->samples,
+                             ARCHIVE_BLOCK_SAMPLES, &reader->info) < 0) {
+        return -1;
+    }
+    return 1;
+}
+
+// Lê o próximo bloco: 1 = ok, 0 = fim do arquivo, -1 = erro. Um bloco
+// corrompido ou truncado é pulado até o próximo cabeçalho válido, para que uma
+// gravação interrompida não encerre o replay do resto do arquivo
+static int archive_reader_load_block(archive_reader_t *reader) {
+    off_t start = lseek(reader->fd, 0, SEEK_CUR);
+    off_t skipped = 0;
+
+    for (;;) {
+        int result = archive_reader_read_block(reader);
+        if (result >= 0) {
+            if (skipped > 0) {
+                fprintf(stderr, "Aviso: %lld bytes inválidos ignorados no arquivo de áudio.\n",
+                        (long long)skipped);
+            }
+            if (result == 0) return 0;
+            reader->position = 0;
+            return 1;
+        }
+
+        off_t found;
+        result = (start < 0) ? -1 : archive_reader_resync(reader, start + 1, &found);
+        if (result < 0) {
+            fprintf(stderr, "Erro: falha ao ler o arquivo de áudio: %s\n", strerror(errno));
+            return -1;
+        }
+        skipped += found - start;
+        start = found;
+    }
+}
+
+int archive_reader_next_frame(archive_reader_t *reader, adc_frame_t *frame, struct timespec *timestamp) {
+    while (reader->position + NUM_SAMPLES > reader->info.sample_count) {
+        int result = archive_reader_load_block(reader);
+        if (result <= 0) return result;
+    }
+
+    memcpy(frame->samples, reader->samples + reader->position, sizeof(frame->samples));
+
+    // Instante do frame interpolado entre o primeiro e o último frame do bloco
+    int frames = reader->info.sample_count / NUM_SAMPLES;
+    int index = reader->position / NUM_SAMPLES;
+    long long offset_ns = (frames > 1) ? (long long)reader->info.duration_us * 1000 * index / (frames - 1) : 0;
+    long long nsec = reader->info.start.tv_nsec + offset_ns;
+    timestamp->tv_sec = reader->info.start.tv_sec + nsec / 1000000000LL;
+    timestamp->tv_nsec = nsec % 1000000000LL;
+
+    reader->position += NUM_SAMPLES;
+    return 1;
+}
+
+void archive_reader_close(archive_reader_t *reader) {
+    if (reader->fd >= 0) {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+}
@@ -0,0 +1,126 @@
+#include "arena.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static unsigned char *arena_base = NULL;
+static size_t arena_size = 0;
+static size_t arena_offset = 0;
+static int arena_sealed = 0;
+
+int arena_init(size_t size) {
+    size = ARENA_ALIGN_UP(size);
+    arena_base = aligned_alloc(ARENA_ALIGN, size);
+    if (arena_base == NULL) {
+        fprintf(stderr, "Erro ao alocar arena de %zu bytes.\n", size);
+        return -1;
+    }
+
+    // Toca todas as páginas agora para não haver page faults no loop principal
+    memset(arena_base, 0, size);
+    arena_size = size;
+    arena_offset = 0;
+    arena_sealed = 0;
+    return 0;
+}
+
+void *arena_alloc(size_t size) {
+    if (arena_sealed) {
+        fprintf(stderr, "Erro: alocação de %zu bytes na arena após a inicialização.\n", size);
+#ifndef NDEBUG
+        abort();
+#endif
+        return NULL;
+    }
+
+    size = ARENA_ALIGN_UP(size);
+    if (arena_base == NULL || arena_offset + size > arena_size) {
+        fprintf(stderr, "Erro: arena sem espaço (%zu de %zu bytes usados, pedido %zu).\n",
+                arena_offset, arena_size, size);
+        return NULL;
+    }
+
+    void *ptr = arena_base + arena_offset;
+    arena_offset += size;
+    return ptr;
+}
+
+void arena_seal(void) {
+    arena_sealed = 1;
+
+    // Trava as páginas atuais e futuras em RAM (requer root)
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        fprintf(stderr, "Aviso: mlockall falhou; páginas podem ser paginadas.\n");
+    }
+}
+
+size_t arena_used(void) {
+    return arena_offset;
+}
+
+size_t arena_capacity(void) {
+    return arena_size;
+}
+
+void arena_cleanup(void) {
+    // Libera o encerramento (saída, liberação de buffers) para alocar de novo
+    munlockall();
+    free(arena_base);
+    arena_base = NULL;
+    arena_size = 0;
+    arena_offset = 0;
+    arena_sealed = 0;
+}
+
+#ifdef ARENA_ALLOC_CHECK
+// Builds de debug substituem o malloc da glibc: as chamadas internas da libc
+// (stdio, localtime_r, pthread, ...) também passam por aqui, e qualquer
+// alocação após arena_seal() aborta o programa
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+static void arena_check_alloc(const char *name, size_t size) {
+    if (arena_sealed) {
+        // stderr não tem buffer: reportar não aloca
+        fprintf(stderr, "Erro: %s(%zu) chamado após a inicialização.\n", name, size);
+        abort();
+    }
+}
+
+void *malloc(size_t size) {
+    arena_check_alloc("malloc", size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    arena_check_alloc("calloc", count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    arena_check_alloc("realloc", size);
+    return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    arena_check_alloc("aligned_alloc", size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    arena_check_alloc("posix_memalign", size);
+    void *result = __libc_memalign(alignment, size);
+    if (result == NULL) return ENOMEM;
+    *ptr = result;
+    return 0;
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+#endif
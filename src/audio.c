@@ -1,8 +1,74 @@
 #include "audio.h"
+#include "arena.h"
 #include "config.h"
+#include "log2_lut.h"
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
+// Linha do terminal: prefixo, BAR_WIDTH blocos UTF-8 (3 bytes) e valores
+#define AUDIO_BAR_PREFIX "Volume: "
+#define AUDIO_BAR_BLOCK "█"
+#define AUDIO_LINE_SIZE (sizeof(AUDIO_BAR_PREFIX) + BAR_WIDTH * (sizeof(AUDIO_BAR_BLOCK) - 1) + 64)
+
+// Buffer de renderização da barra, alocado na arena
+static char *bar_line = NULL;
+
+// Limiares da barra: barra >= k quando o sinal atinge threshold[k - 1]
+static float bar_thresholds[BAR_WIDTH];
+static int64_t bar_thresholds_fixed[BAR_WIDTH];
+
+// Constantes do caminho de ponto fixo, em log2 Q16 e dBFS Q8
+static int32_t log2_ref_fixed;
+static int32_t dbfs_floor_fixed;
+
+// Milivolts por contagem Q4, em Q16 (exibição sem ponto flutuante)
+static uint32_t millivolts_per_q4;
+
+// 10 * log10(2) em Q16
+#define AUDIO_DB_PER_LOG2 197283
+
+// log2(x) em Q16 via tabela com interpolação linear (x > 0)
+static int32_t log2_fixed(uint64_t x) {
+    int n = 63 - __builtin_clzll(x);
+    // Normaliza para 1.f com 32 bits fracionários
+    uint64_t norm = (n >= 32) ? (x >> (n - 32)) : (x << (32 - n));
+    uint32_t frac = (uint32_t)norm;
+    uint32_t idx = frac >> (32 - LOG2_LUT_BITS);
+    uint32_t rem = (frac >> (32 - LOG2_LUT_BITS - 16)) & 0xFFFF;
+    int32_t a = log2_lut[idx];
+    int32_t b = log2_lut[idx + 1];
+    return (n << LOG2_LUT_FRAC) + a + (int32_t)(((int64_t)(b - a) * rem) >> 16);
+}
+
+size_t audio_arena_size(void) {
+    return ARENA_ALIGN_UP(AUDIO_LINE_SIZE);
+}
+
+int audio_init(void) {
+    bar_line = arena_alloc(AUDIO_LINE_SIZE);
+    if (bar_line == NULL) {
+        return -1;
+    }
+
+    // Soma dos quadrados (em contagens) de um frame no nível MAX_RMS
+    const double counts_per_volt = 32768.0 / ADC_FULL_SCALE;
+    const double ref_counts = MAX_RMS * counts_per_volt;
+    const double ref_sum = ref_counts * ref_counts * NUM_SAMPLES;
+
+    // Limiar k: normalized >= MIN_NORMALIZED^(1 - k/BAR_WIDTH)
+    for (int k = 1; k <= BAR_WIDTH; k++) {
+        double threshold = pow(MIN_NORMALIZED, 1.0 - (double)k / BAR_WIDTH);
+        bar_thresholds[k - 1] = (float)threshold;
+        bar_thresholds_fixed[k - 1] = (int64_t)ceil(threshold * threshold * ref_sum);
+    }
+
+    log2_ref_fixed = log2_fixed((uint64_t)llround(ref_sum));
+    dbfs_floor_fixed = (int32_t)lround(20.0 * log10(MIN_RMS / MAX_RMS) * (1 << AUDIO_DB_FRAC_BITS));
+    millivolts_per_q4 = (uint32_t)lround(1000.0 / (counts_per_volt * 16.0) * 65536.0);
+    return 0;
+}
+
 float audio_normalize_rms(float rms) {
     // Pré-calculando constantes para otimização
     const float rms_scale = 1.0f / MAX_RMS;
@@ -16,31 +82,104 @@ float audio_normalize_rms(float rms) {
 float audio_calculate_dbfs(float rms) {
     // Pré-calculando constantes para otimização
     const float rms_scale = 1.0f / MAX_RMS;
-    const float log_scale = 20.0f / log(10.0f);
+    const float log_scale = 20.0f / logf(10.0f);
     
     // Cálculo do valor dBFS do sinal RMS
-    return log_scale * logf((rms > 0.0001f ? rms : 0.0001f) * rms_scale);
+    return log_scale * logf((rms > MIN_RMS ? rms : MIN_RMS) * rms_scale);
 }
 
 int audio_calculate_bar_length(float normalized) {
-    float norm_clamped = (normalized < MIN_NORMALIZED) ? MIN_NORMALIZED : normalized;
-    int barLength = (int)((logf(norm_clamped) - logf(MIN_NORMALIZED)) / 
-                          (-logf(MIN_NORMALIZED)) * BAR_WIDTH);
-    if (barLength < 0) barLength = 0;
-    if (barLength > BAR_WIDTH) barLength = BAR_WIDTH;
-    return barLength;
+    // Busca binária na tabela de limiares (sem logf por frame)
+    int lo = 0, hi = BAR_WIDTH;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (normalized >= bar_thresholds[mid]) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int32_t audio_calculate_dbfs_fixed(int64_t sum_squares) {
+    if (sum_squares <= 0) return dbfs_floor_fixed;
+
+    // dBFS = 10 * log10(2) * (log2(soma) - log2(soma de referência))
+    int32_t log2_diff = log2_fixed((uint64_t)sum_squares) - log2_ref_fixed;
+    int32_t dbfs = (int32_t)(((int64_t)log2_diff * AUDIO_DB_PER_LOG2) >> (2 * LOG2_LUT_FRAC - AUDIO_DB_FRAC_BITS));
+    return (dbfs > dbfs_floor_fixed) ? dbfs : dbfs_floor_fixed;
+}
+
+int32_t audio_ratio_db_fixed(uint64_t num, uint64_t den) {
+    if (num == 0 || den == 0) return 0;
+
+    // 20 * log10(num / den) em Q8, razão de amplitudes
+    int32_t log2_diff = log2_fixed(num) - log2_fixed(den);
+    return (int32_t)(((int64_t)log2_diff * 2 * AUDIO_DB_PER_LOG2) >> (2 * LOG2_LUT_FRAC - AUDIO_DB_FRAC_BITS));
+}
+
+void audio_format_db(char *buffer, size_t size, int32_t db_q8) {
+    // Equivalente a "%.1f" com décimos arredondados a partir do Q8
+    const int32_t half = 1 << (AUDIO_DB_FRAC_BITS - 1);
+    int32_t mag = (db_q8 < 0) ? -db_q8 : db_q8;
+    int32_t tenths = (mag * 10 + half) >> AUDIO_DB_FRAC_BITS;
+
+    snprintf(buffer, size, "%s%d.%d", (db_q8 < 0 && tenths > 0) ? "-" : "",
+             tenths / 10, tenths % 10);
+}
+
+void audio_format_volts(char *buffer, size_t size, uint32_t counts_q4) {
+    // Equivalente a "%.3f" em volts
+    uint32_t mv = (uint32_t)(((uint64_t)counts_q4 * millivolts_per_q4 + 0x8000) >> 16);
+    snprintf(buffer, size, "%u.%03u", mv / 1000, mv % 1000);
+}
+
+int audio_calculate_bar_length_fixed(int64_t sum_squares) {
+    // Mesma busca, comparando direto a soma dos quadrados (sem raiz nem log)
+    int lo = 0, hi = BAR_WIDTH;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (sum_squares >= bar_thresholds_fixed[mid]) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
 }
 
 void audio_print_bar(float rms, float dbfs) {
     float normalized = audio_normalize_rms(rms);
-    int barLength = audio_calculate_bar_length(normalized);
-    
-    printf("Volume: ");
+    audio_print_bar_length(audio_calculate_bar_length(normalized), rms, dbfs);
+}
+
+// Escreve prefixo e blocos da barra no buffer; retorna o fim da linha
+static char *audio_render_bar(int barLength) {
+    const size_t block_len = sizeof(AUDIO_BAR_BLOCK) - 1;
+    char *pos = bar_line;
+
+    memcpy(pos, AUDIO_BAR_PREFIX, sizeof(AUDIO_BAR_PREFIX) - 1);
+    pos += sizeof(AUDIO_BAR_PREFIX) - 1;
     for (int i = 0; i < BAR_WIDTH; i++) {
-        if (i < barLength)
-            printf("█");
-        else
-            printf(" ");
+        if (i < barLength) {
+            memcpy(pos, AUDIO_BAR_BLOCK, block_len);
+            pos += block_len;
+        } else {
+            *pos++ = ' ';
+        }
     }
-    printf(" | RMS: %5.3f V | dBFS: %6.1f dB\n", rms, dbfs);
-}
\ No newline at end of file
+    return pos;
+}
+
+void audio_print_bar_length(int barLength, float rms, float dbfs) {
+    // Monta a linha inteira no buffer e escreve de uma vez
+    char *pos = audio_render_bar(barLength);
+    snprintf(pos, AUDIO_LINE_SIZE - (pos - bar_line), " | RMS: %5.3f V | dBFS: %6.1f dB\n", rms, dbfs);
+    fputs(bar_line, stdout);
+}
+
+void audio_print_bar_fixed(int barLength, uint32_t rms_q4, int32_t dbfs_q8) {
+    // Mesma linha, formatada sem ponto flutuante
+    char rms_str[16], dbfs_str[16];
+    char *pos = audio_render_bar(barLength);
+
+    audio_format_volts(rms_str, sizeof(rms_str), rms_q4);
+    audio_format_db(dbfs_str, sizeof(dbfs_str), dbfs_q8);
+    snprintf(pos, AUDIO_LINE_SIZE - (pos - bar_line), " | RMS: %5s V | dBFS: %6s dB\n", rms_str, dbfs_str);
+    fputs(bar_line, stdout);
+}
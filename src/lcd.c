@@ -1,12 +1,50 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <wiringPiI2C.h>
 
 #include "lcd.h"
+#include "arena.h"
 #include "config.h"
 
+// Duas linhas de LCD_COLS células
+#define LCD_FRAME_SIZE (2 * LCD_COLS)
+
+// Slots CGRAM: 0-4 = blocos parciais de 1 a 5 colunas, 5-7 = marcadores de pico.
+// O marcador da coluna 0 é o próprio bloco parcial de 1 coluna (slot 0)
+#define LCD_GLYPH_MARKER 5
+
 static int lcd_fd = -1;
+static pthread_t lcd_thread;
+static int lcd_thread_started = 0;
+static atomic_int lcd_ready = 0;
+static atomic_int lcd_failed = 0;
+static atomic_int lcd_running = 0;
+
+// Estado do medidor: escrito pelo loop principal, lido pela thread do LCD
+static pthread_mutex_t meter_lock = PTHREAD_MUTEX_INITIALIZER;
+static int meter_level = 0;
+static int meter_peak = 0;
+static char *meter_text = NULL;    // Linha 2 desejada (LCD_COLS caracteres)
+static char *meter_frame = NULL;   // Quadro renderizado
+static char *meter_shadow = NULL;  // Conteúdo atual do LCD
+static int meter_flush_pos = 0;    // Célula onde o próximo flush retoma
+
+// Padrões 5x8: blocos parciais preenchidos a partir da esquerda e marcadores
+// de uma coluna nas posições 1, 2 e 4
+static const uint8_t lcd_glyph_columns[8] = {
+    0x10, 0x18, 0x1C, 0x1E, 0x1F, 0x08, 0x04, 0x01
+};
+
+// Glifo do marcador para cada coluna da célula; a coluna 3 usa a 4 (o
+// marcador nunca aparece abaixo do pico)
+static const char lcd_marker_glyph[5] = {
+    0, LCD_GLYPH_MARKER, LCD_GLYPH_MARKER + 1, LCD_GLYPH_MARKER + 2, LCD_GLYPH_MARKER + 2
+};
 
 void lcd_toggle_enable(uint8_t bits) {
     wiringPiI2CWrite(lcd_fd, bits | LCD_ENABLE | LCD_BACKLIGHT);
@@ -24,11 +62,16 @@ void lcd_send_byte(uint8_t bits, int mode) {
     lcd_toggle_enable(low);
 }
 
-void lcd_init(void) {
+int lcd_init(void) {
     lcd_fd = wiringPiI2CSetup(LCD_I2C_ADDR);
-    if (lcd_fd < 0) {
+    // O setup não fala com o dispositivo: uma leitura confirma que o LCD responde
+    if (lcd_fd < 0 || wiringPiI2CRead(lcd_fd) < 0) {
         fprintf(stderr, "Erro ao inicializar LCD I2C.\n");
-        exit(EXIT_FAILURE);
+        if (lcd_fd >= 0) {
+            close(lcd_fd);
+            lcd_fd = -1;
+        }
+        return -1;
     }
 
     usleep(50000);                // Espera >40ms após VCC
@@ -37,8 +80,178 @@ void lcd_init(void) {
     lcd_send_byte(0x28, LCD_CMD); // 2 linhas, 5x8 matriz
     lcd_send_byte(0x0C, LCD_CMD); // Display on, cursor off
     lcd_send_byte(0x06, LCD_CMD); // Incrementa cursor
+
+    // Carrega os caracteres do medidor na CGRAM (uma vez só)
+    lcd_send_byte(0x40, LCD_CMD); // Endereço 0 da CGRAM
+    for (int glyph = 0; glyph < 8; glyph++) {
+        for (int row = 0; row < 8; row++) {
+            lcd_send_byte(row == 7 ? 0x00 : lcd_glyph_columns[glyph], LCD_CHR);
+        }
+    }
+
     lcd_send_byte(0x01, LCD_CMD); // Limpa display
     usleep(2000);
+    return 0;
+}
+
+// Renderiza o quadro do medidor: barra na linha 1 e texto na linha 2
+static void lcd_meter_render(int level, int peak) {
+    int peak_cell = (peak > 0) ? (peak - 1) / 5 : -1;
+
+    for (int cell = 0; cell < LCD_COLS; cell++) {
+        int fill = level - cell * 5;
+        if (fill >= 5) {
+            meter_frame[cell] = 4;
+        } else if (fill > 0) {
+            meter_frame[cell] = (char)(fill - 1);
+        } else if (cell == peak_cell) {
+            // Marcador na coluna do pico
+            meter_frame[cell] = lcd_marker_glyph[(peak - 1) % 5];
+        } else {
+            meter_frame[cell] = ' ';
+        }
+    }
+}
+
+// Envia só as células alteradas, limitado a LCD_METER_MAX_BYTES por quadro.
+// Cada quadro retoma a varredura onde o anterior parou (round-robin), para a
+// linha 2 não ficar sem orçamento enquanto a barra da linha 1 oscila
+static void lcd_meter_flush(void) {
+    int budget = LCD_METER_MAX_BYTES;
+    int cursor = -1;
+
+    for (int scanned = 0; scanned < LCD_FRAME_SIZE; scanned++) {
+        int pos = meter_flush_pos;
+        if (meter_frame[pos] != meter_shadow[pos]) {
+            // Reposiciona o cursor só quando a célula não é a seguinte à última escrita
+            int cost = (cursor != pos) ? 2 : 1;
+            if (budget < cost) break;
+            if (cursor != pos) {
+                uint8_t row_addr = (pos < LCD_COLS) ? 0x80 : 0xC0;
+                lcd_send_byte(row_addr | (pos % LCD_COLS), LCD_CMD);
+            }
+            lcd_send_byte((uint8_t)meter_frame[pos], LCD_CHR);
+            budget -= cost;
+            meter_shadow[pos] = meter_frame[pos];
+            cursor = (pos + 1 == LCD_COLS || pos + 1 == LCD_FRAME_SIZE) ? -1 : pos + 1;
+        }
+        meter_flush_pos = (pos + 1) % LCD_FRAME_SIZE;
+    }
+}
+
+static void lcd_meter_loop(void) {
+    const long long interval_ns = 1000000000LL / LCD_METER_FPS;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (atomic_load(&lcd_running)) {
+        pthread_mutex_lock(&meter_lock);
+        int level = meter_level;
+        int peak = meter_peak;
+        memcpy(meter_frame + LCD_COLS, meter_text, LCD_COLS);
+        pthread_mutex_unlock(&meter_lock);
+
+        lcd_meter_render(level, peak);
+        lcd_meter_flush();
+
+        // Próximo quadro em tempo absoluto, sem acumular atraso
+        next.tv_nsec += interval_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+}
+
+static void *lcd_init_thread(void *arg) {
+    int meter_mode = *(int *)arg;
+    if (lcd_init() < 0) {
+        // Registra a falha; o loop principal decide como seguir sem o LCD
+        atomic_store(&lcd_failed, 1);
+        return NULL;
+    }
+    lcd_write("Iniciando...", "Aguarde...");
+    // Só libera o LCD para o loop principal após a última escrita da thread
+    atomic_store(&lcd_ready, 1);
+
+    if (meter_mode) {
+        lcd_send_byte(0x01, LCD_CMD); // Limpa display
+        usleep(2000);
+        memset(meter_shadow, ' ', LCD_FRAME_SIZE);
+        meter_flush_pos = 0;
+        lcd_meter_loop();
+    }
+    return NULL;
+}
+
+int lcd_init_async(int meter_mode) {
+    static int thread_meter_mode;
+    thread_meter_mode = meter_mode && meter_frame != NULL;
+    atomic_store(&lcd_running, 1);
+
+    // Inicializa o LCD (>50 ms de esperas) em paralelo com a aquisição
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, THREAD_STACK_SIZE);
+    int created = pthread_create(&lcd_thread, &attr, lcd_init_thread, &thread_meter_mode);
+    pthread_attr_destroy(&attr);
+    if (created != 0) {
+        fprintf(stderr, "Aviso: thread do LCD indisponível, inicializando de forma síncrona.\n");
+        thread_meter_mode = 0;
+        lcd_init_thread(&thread_meter_mode);
+        return 0;
+    }
+    lcd_thread_started = 1;
+    return thread_meter_mode;
+}
+
+int lcd_is_ready(void) {
+    return atomic_load(&lcd_ready);
+}
+
+int lcd_has_failed(void) {
+    return atomic_load(&lcd_failed);
+}
+
+void lcd_stop(void) {
+    atomic_store(&lcd_running, 0);
+    if (lcd_thread_started) {
+        pthread_join(lcd_thread, NULL);
+        lcd_thread_started = 0;
+    }
+}
+
+size_t lcd_arena_size(void) {
+    return ARENA_ALIGN_UP(LCD_COLS) + 2 * ARENA_ALIGN_UP(LCD_FRAME_SIZE);
+}
+
+int lcd_meter_init(void) {
+    meter_text = arena_alloc(LCD_COLS);
+    meter_frame = arena_alloc(LCD_FRAME_SIZE);
+    meter_shadow = arena_alloc(LCD_FRAME_SIZE);
+    if (meter_text == NULL || meter_frame == NULL || meter_shadow == NULL) {
+        return -1;
+    }
+    memset(meter_text, ' ', LCD_COLS);
+    return 0;
+}
+
+void lcd_meter_update(int level_steps, int peak_steps) {
+    pthread_mutex_lock(&meter_lock);
+    meter_level = level_steps;
+    meter_peak = peak_steps;
+    pthread_mutex_unlock(&meter_lock);
+}
+
+void lcd_meter_set_text(const char *line2) {
+    pthread_mutex_lock(&meter_lock);
+    int i = 0;
+    for (; i < LCD_COLS && line2[i]; i++)
+        meter_text[i] = line2[i];
+    for (; i < LCD_COLS; i++)
+        meter_text[i] = ' ';
+    pthread_mutex_unlock(&meter_lock);
 }
 
 void lcd_write(const char *line1, const char *line2) {
@@ -1,14 +1,19 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <unistd.h>
 #include <signal.h>
 #include <time.h>
 #include <wiringPi.h>
 
 #include "config.h"
+#include "arena.h"
+#include "archive.h"
 #include "lcd.h"
 #include "adc.h"
 #include "audio.h"
+#include "peak.h"
 #include "timing.h"
 
 volatile int keep_running = 1;
@@ -18,15 +23,28 @@ void intHandler(int dummy) {
     keep_running = 0;
 }
 
+// Opções da linha de comando
+typedef struct {
+    float dbfs_limit;
+    float crest_limit;
+    int meter_mode;
+    const char *archive_path;   // Grava o áudio bruto comprimido (NULL = desabilitado)
+    const char *replay_path;    // Processa um arquivo gravado em vez do ADC
+} options_t;
+
 void print_usage(const char *program_name);
-int parse_arguments(int argc, char *argv[], float *dbfs_limit);
+int parse_arguments(int argc, char *argv[], options_t *options);
 
 int main(int argc, char *argv[]) {
 
-    float dbfs_limit;
+    // Marca o início para medir o tempo até a primeira medição
+    struct timespec startup;
+    clock_gettime(CLOCK_MONOTONIC, &startup);
+
+    options_t options;
 
     // Processa argumentos da linha de comando
-    int parse_result = parse_arguments(argc, argv, &dbfs_limit);
+    int parse_result = parse_arguments(argc, argv, &options);
     if (parse_result == 0) {
         return EXIT_SUCCESS; // --help foi chamado
     }
@@ -34,49 +52,157 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE; // Erro nos argumentos
     }
 
-    if (wiringPiSetupGpio() < 0) {
-        fprintf(stderr, "Erro ao inicializar WiringPi.\n");
-        return EXIT_FAILURE;
+    // No replay não há hardware: os frames vêm do arquivo gravado
+    int replay = (options.replay_path != NULL);
+    int meter_mode = options.meter_mode && !replay;
+
+    if (!replay) {
+        if (wiringPiSetupGpio() < 0) {
+            fprintf(stderr, "Erro ao inicializar WiringPi.\n");
+            return EXIT_FAILURE;
+        }
+        pinMode(LED_GPIO, OUTPUT);
     }
     
     signal(SIGINT, intHandler);
 
-    pinMode(LED_GPIO, OUTPUT);
+    // Todos os buffers do loop vêm de uma única arena dimensionada pela configuração
+    size_t arena_size = ARENA_ALIGN_UP(sizeof(adc_frame_t)) + audio_arena_size();
+    if (meter_mode) {
+        arena_size += lcd_arena_size();
+    }
+    if (options.archive_path) {
+        arena_size += archive_writer_arena_size();
+    }
+    if (replay) {
+        arena_size += archive_reader_arena_size();
+    }
+    if (arena_init(arena_size) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    adc_frame_t *frame = arena_alloc(sizeof(adc_frame_t));
+    if (frame == NULL || audio_init() < 0) {
+        return EXIT_FAILURE;
+    }
+    if (meter_mode && lcd_meter_init() < 0) {
+        return EXIT_FAILURE;
+    }
+
+    int adc_handle = -1;
+    archive_reader_t reader;
+    if (replay) {
+        if (archive_reader_open(&reader, options.replay_path) < 0) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        // O LCD inicializa em paralelo; a aquisição não espera por ele
+        meter_mode = lcd_init_async(meter_mode);
 
-    lcd_init();
-    lcd_write("Iniciando...", "Aguarde...");
+        adc_handle = adc_init();
+        if (adc_handle < 0) {
+            return EXIT_FAILURE;
+        }
+    }
 
-    int adc_handle = adc_init();
-    if (adc_handle < 0) {
+    if (options.archive_path && archive_writer_init(options.archive_path) < 0) {
         return EXIT_FAILURE;
     }
+
+    peak_tracker_t peak;
+    peak_event_t event;
+    peak_init(&peak, options.crest_limit);
+
+    // Carrega o fuso horário agora (localtime_r aloca na primeira chamada)
+    tzset();
     
     printf("Iniciando leitura...\n");
     printf("Pressione Ctrl+C encerrar.\n");
 
+    // A partir daqui o loop não aloca memória
+    arena_seal();
+
+#if AUDIO_FIXED_POINT
+    int64_t dbfs_sum = 0;   // dBFS Q8
+    const int32_t dbfs_limit = (int32_t)lroundf(options.dbfs_limit * (1 << AUDIO_DB_FRAC_BITS));
+#else
     float dbfs_sum = 0.0f;
-    float dbfs_avg = 0.0f;
+#endif
     int count = 0;
 
     struct timespec loop_start;
+    struct timespec frame_time;
     struct timespec avg_start, avg_current;
     int avg_initialized = 0;
+    int first_measurement = 1;
+    int lcd_available = !replay;
 
     while (keep_running) {
         // Marca o início do loop
         clock_gettime(CLOCK_MONOTONIC, &loop_start);
 
-        float rms = adc_calculate_rms(adc_handle);
+        if (replay) {
+            int result = archive_reader_next_frame(&reader, frame, &frame_time);
+            if (result <= 0) {
+                break; // Fim do arquivo (ou erro, já reportado)
+            }
+            adc_process_frame(frame);
+        } else {
+            adc_read_frame(adc_handle, frame);
+            clock_gettime(CLOCK_REALTIME, &frame_time);
+            if (options.archive_path) {
+                archive_writer_push(frame, &frame_time);
+            }
+        }
         
+#if AUDIO_FIXED_POINT
+        // Caminho inteiro: dBFS via tabela log2, barra via limiares e exibição sem float
+        int32_t dbfs = audio_calculate_dbfs_fixed(frame->sum_squares);
+        int bar_length = audio_calculate_bar_length_fixed(frame->sum_squares);
+        audio_print_bar_fixed(bar_length, frame->rms_q4, dbfs);
+#else
+        float rms = frame->rms;
         float dbfs = audio_calculate_dbfs(rms);
-        
-        audio_print_bar(rms, dbfs);
+        int bar_length = audio_calculate_bar_length(audio_normalize_rms(rms));
+        audio_print_bar_length(bar_length, rms, dbfs);
+#endif
+
+        // Caminho de pico: peak-hold, fator de crista e eventos impulsivos
+        if (peak_update(&peak, frame, &event)) {
+            if (replay) {
+                event.timestamp = frame_time; // Instante da gravação, não do replay
+            }
+            peak_print_event(&event);
+        }
+
+        // Medidor no LCD: a thread do LCD amostra este estado a LCD_METER_FPS
+        if (meter_mode) {
+            int hold_length = audio_calculate_bar_length_fixed(peak_hold_sum_squares(&peak));
+            lcd_meter_update(bar_length * LCD_METER_STEPS / BAR_WIDTH,
+                             hold_length * LCD_METER_STEPS / BAR_WIDTH);
+        }
+
+        if (first_measurement) {
+            struct timespec first;
+            clock_gettime(CLOCK_MONOTONIC, &first);
+            printf("Primeira medição em %.1f ms (arena: %zu/%zu bytes)\n",
+                   timespec_diff_ns(&startup, &first) / 1000000.0,
+                   arena_used(), arena_capacity());
+            first_measurement = 0;
+        }
         
         fflush(stdout);
 
+        // No replay a média segue o relógio da gravação
+        if (replay) {
+            avg_current = frame_time;
+        } else {
+            clock_gettime(CLOCK_MONOTONIC, &avg_current);
+        }
+
         // Inicializa o timestamp para média se ainda não foi feito
         if (!avg_initialized) {
-            clock_gettime(CLOCK_MONOTONIC, &avg_start);
+            avg_start = avg_current;
             avg_initialized = 1;
         }
         
@@ -84,38 +210,76 @@ int main(int argc, char *argv[]) {
         count++;
 
         // Verifica se passou 1 segundo desde o início da média
-        clock_gettime(CLOCK_MONOTONIC, &avg_current);
         long long avg_elapsed_ns = timespec_diff_ns(&avg_start, &avg_current);
         
         if (avg_elapsed_ns >= 1000000000LL) { // 1 segundo em nanosegundos
-            dbfs_avg = dbfs_sum / count;
+            char avg_str[8], hold_str[8], crest_str[8];
+#if AUDIO_FIXED_POINT
+            int32_t dbfs_avg = (int32_t)(dbfs_sum / count);
+            long long avg_elapsed_cs = (avg_elapsed_ns + 5000000LL) / 10000000LL;
+            int over_limit = dbfs_avg > dbfs_limit;
+            audio_format_db(avg_str, sizeof(avg_str), dbfs_avg);
+            printf("Average dBFS: %6s dB (%d samples in %lld.%02lld s)\n",
+                   avg_str, count, avg_elapsed_cs / 100, avg_elapsed_cs % 100);
+#else
+            float dbfs_avg = dbfs_sum / count;
+            int over_limit = dbfs_avg > options.dbfs_limit;
+            snprintf(avg_str, sizeof(avg_str), "%.1f", dbfs_avg);
             printf("Average dBFS: %6.1f dB (%d samples in %.2f s)\n", 
                    dbfs_avg, count, avg_elapsed_ns / 1000000000.0);
+#endif
+            audio_format_db(hold_str, sizeof(hold_str),
+                            audio_calculate_dbfs_fixed(peak_hold_sum_squares(&peak)));
+            audio_format_db(crest_str, sizeof(crest_str), peak_crest_db(&peak));
+            printf("Peak hold: %6s dBFS | Crest: %5s dB | Impulses: %d\n",
+                   hold_str, crest_str, peak.event_count);
+            peak_reset_window(&peak);
+
+            // Sem LCD o monitoramento continua (terminal, LED e arquivo)
+            if (lcd_has_failed() && lcd_available) {
+                fprintf(stderr, "Aviso: LCD indisponível, continuando sem display.\n");
+                lcd_available = 0;
+                meter_mode = 0;
+            }
 
             char lcd_line1[17], lcd_line2[17];
             snprintf(lcd_line1, sizeof(lcd_line1), "Nivel Medio:");
-            snprintf(lcd_line2, sizeof(lcd_line2), "%6.1f dBFS", dbfs_avg);
-            lcd_write(lcd_line1, lcd_line2);
+            snprintf(lcd_line2, sizeof(lcd_line2), "%6s dBFS", avg_str);
+            if (meter_mode) {
+                snprintf(lcd_line2, sizeof(lcd_line2), "Med %6s dBFS", avg_str);
+                lcd_meter_set_text(lcd_line2);
+            } else if (lcd_available && lcd_is_ready()) {
+                lcd_write(lcd_line1, lcd_line2);
+            }
 
-            if (dbfs_avg > dbfs_limit) {
+            if (over_limit) {
                 printf("LED on...\n");
-                digitalWrite(LED_GPIO, HIGH);               
+                if (!replay) digitalWrite(LED_GPIO, HIGH);               
             } else {
                 printf("LED off..\n");
-                digitalWrite(LED_GPIO, LOW);
+                if (!replay) digitalWrite(LED_GPIO, LOW);
             }
             
             // Reset para próxima média
-            dbfs_sum = 0.0f;
+            dbfs_sum = 0;
             count = 0;
-            clock_gettime(CLOCK_MONOTONIC, &avg_start);
+            avg_start = avg_current;
         }
 
-        // Aguarda para manter o intervalo de tempo desejado
-        timing_wait_for_interval(&loop_start);
+        // Aguarda para manter o intervalo de tempo desejado (o replay roda sem espera)
+        if (!replay) {
+            timing_wait_for_interval(&loop_start);
+        }
     }
 
-    lcd_cleanup();
+    archive_writer_stop();
+    if (replay) {
+        archive_reader_close(&reader);
+    } else {
+        lcd_stop();
+        lcd_cleanup();
+    }
+    arena_cleanup();
     printf("\nTerminando o programa.\n");
     return EXIT_SUCCESS;
 }
@@ -129,6 +293,13 @@ void print_usage(const char *program_name) {
     printf("\nOPÇÕES:\n");
     printf("  -l, --limit VALOR    Define o limite dBFS para ativação do LED\n");
     printf("                       (padrão: -12.0 dBFS)\n");
+    printf("  -c, --crest-limit VALOR\n");
+    printf("                       Razão pico/RMS (dB) para detectar eventos impulsivos\n");
+    printf("                       (padrão: %.1f dB)\n", PEAK_CREST_LIMIT_DB);
+    printf("  -m, --meter          Mostra no LCD um medidor de barra em tempo real\n");
+    printf("                       com marcador de pico\n");
+    printf("  -a, --archive ARQ    Grava o áudio bruto com compressão sem perdas em ARQ\n");
+    printf("  -r, --replay ARQ     Processa um arquivo gravado com -a, sem hardware\n");
     printf("  -h, --help          Mostra esta mensagem de ajuda\n");
     printf("\nEXEMPLOS:\n");
     printf("  %s                  # Usa limite padrão de -12.0 dBFS\n", program_name);
@@ -140,8 +311,12 @@ void print_usage(const char *program_name) {
     printf("  • Valores dBFS típicos: -60 a 0 (0 = máximo, -60 = muito baixo)\n");
 }
 
-int parse_arguments(int argc, char *argv[], float *dbfs_limit) {
-    *dbfs_limit = -12.0f; // Valor padrão
+int parse_arguments(int argc, char *argv[], options_t *options) {
+    options->dbfs_limit = -12.0f; // Valor padrão
+    options->crest_limit = PEAK_CREST_LIMIT_DB;
+    options->meter_mode = 0;
+    options->archive_path = NULL;
+    options->replay_path = NULL;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -175,9 +350,46 @@ int parse_arguments(int argc, char *argv[], float *dbfs_limit) {
                 }
             }
             
-            *dbfs_limit = value;
+            options->dbfs_limit = value;
             i++; // Pula o próximo argumento (valor do limite)
         }
+        else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--crest-limit") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: Opção '%s' requer um valor.\n", argv[i]);
+                print_usage(argv[0]);
+                return -1;
+            }
+
+            char *endptr;
+            float value = strtof(argv[i + 1], &endptr);
+
+            if (*endptr != '\0' || value <= 0.0f) {
+                fprintf(stderr, "Erro: Razão de crista '%s' deve ser um número positivo.\n", argv[i + 1]);
+                print_usage(argv[0]);
+                return -1;
+            }
+
+            options->crest_limit = value;
+            i++; // Pula o próximo argumento (valor da razão)
+        }
+        else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--meter") == 0) {
+            options->meter_mode = 1;
+        }
+        else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--archive") == 0 ||
+                 strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--replay") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: Opção '%s' requer um arquivo.\n", argv[i]);
+                print_usage(argv[0]);
+                return -1;
+            }
+
+            if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--archive") == 0) {
+                options->archive_path = argv[i + 1];
+            } else {
+                options->replay_path = argv[i + 1];
+            }
+            i++; // Pula o próximo argumento (arquivo)
+        }
         else {
             fprintf(stderr, "Erro: Opção desconhecida '%s'.\n", argv[i]);
             print_usage(argv[0]);
@@ -185,5 +397,10 @@ int parse_arguments(int argc, char *argv[], float *dbfs_limit) {
         }
     }
     
+    if (options->archive_path && options->replay_path) {
+        fprintf(stderr, "Erro: '--archive' e '--replay' não podem ser usados juntos.\n");
+        return -1;
+    }
+    
     return 1; // Sucesso, continuar execução
 }
@@ -0,0 +1,114 @@
+#include "peak.h"
+#include "audio.h"
+#include "config.h"
+#include <stdio.h>
+#include <math.h>
+
+// Alfa da média exponencial do fundo (Q16)
+#define PEAK_BACKGROUND_ALPHA_Q16 ((int32_t)(PEAK_BACKGROUND_ALPHA * 65536.0f + 0.5f))
+
+void peak_init(peak_tracker_t *tracker, float crest_limit_db) {
+    // Pré-calculando constantes (ponto flutuante só aqui, fora do loop)
+    const float frame_s = TARGET_INTERVAL_NS / 1000000000.0f;
+    const float counts_q12_per_volt = 32768.0f / ADC_FULL_SCALE * 4096.0f;
+
+    tracker->hold = 0;
+    tracker->hold_frames = 0;
+    tracker->decay_factor = (int32_t)lroundf(powf(10.0f, -PEAK_HOLD_DECAY_DB_S * frame_s / 20.0f) * 65536.0f);
+    tracker->min_background = (int32_t)lroundf(PEAK_MIN_BACKGROUND * counts_q12_per_volt);
+    tracker->background = tracker->min_background;
+    tracker->window_peak = 0;
+    tracker->window_power = 0;
+    tracker->window_frames = 0;
+    tracker->crest_limit = (int32_t)lroundf(powf(10.0f, crest_limit_db / 20.0f) * 256.0f);
+    tracker->refractory = 0;
+    // Aguarda o RMS de fundo convergir antes de detectar eventos
+    tracker->warmup = (int)(1.0f / PEAK_BACKGROUND_ALPHA);
+    tracker->event_count = 0;
+}
+
+int peak_update(peak_tracker_t *tracker, const adc_frame_t *frame, peak_event_t *event) {
+    int32_t peak = frame->true_peak_counts;
+    uint32_t rms_q4 = frame->rms_q4;
+
+    // Peak-hold: retém o maior pico e decai após o tempo de retenção
+    if (peak >= tracker->hold) {
+        tracker->hold = peak;
+        tracker->hold_frames = PEAK_HOLD_FRAMES;
+    } else if (tracker->hold_frames > 0) {
+        tracker->hold_frames--;
+    } else {
+        tracker->hold = (int32_t)(((int64_t)tracker->hold * tracker->decay_factor) >> 16);
+        if (tracker->hold < peak) tracker->hold = peak;
+    }
+
+    // Acumuladores da janela: o fator de crista de um frame de 4 amostras não
+    // passa de sqrt(NUM_SAMPLES), então o impulso é medido contra a janela toda
+    if (peak > tracker->window_peak) tracker->window_peak = peak;
+    tracker->window_power += (uint64_t)rms_q4 * rms_q4;
+    tracker->window_frames++;
+
+    // Detecção de impulso contra o RMS de fundo (anterior ao frame atual)
+    int32_t background = (tracker->background > tracker->min_background) ?
+                         tracker->background : tracker->min_background;
+    int64_t peak_q12 = (int64_t)peak << 12;
+
+    if (tracker->warmup > 0) {
+        tracker->warmup--;
+    } else if (tracker->refractory > 0) {
+        // Janela pós-evento: o impulso não deve contaminar o fundo
+        tracker->refractory--;
+        return 0;
+    } else if (peak_q12 * 256 > (int64_t)tracker->crest_limit * background) {
+        clock_gettime(CLOCK_REALTIME, &event->timestamp);
+        event->peak = peak;
+        event->background_q4 = (uint32_t)background >> 8;
+        event->ratio_db = audio_ratio_db_fixed((uint64_t)peak_q12, (uint64_t)background);
+        tracker->refractory = PEAK_EVENT_REFRACTORY;
+        tracker->event_count++;
+        return 1;
+    }
+
+    int32_t rms_q12 = (int32_t)(rms_q4 << 8);
+    tracker->background += (int32_t)(((int64_t)(rms_q12 - tracker->background) *
+                                      PEAK_BACKGROUND_ALPHA_Q16) >> 16);
+    return 0;
+}
+
+int64_t peak_hold_sum_squares(const peak_tracker_t *tracker) {
+    // RMS de uma senóide = pico / sqrt(2): soma = N * pico^2 / 2
+    return (int64_t)tracker->hold * tracker->hold * NUM_SAMPLES / 2;
+}
+
+int32_t peak_crest_db(const peak_tracker_t *tracker) {
+    // rms_q4^2 = 256 * soma dos quadrados / NUM_SAMPLES, logo a média de rms_q4^2
+    // é o quadrado do RMS da janela em Q4. Razão de potências: metade dos dB de amplitude
+    uint64_t peak_power = (uint64_t)tracker->window_peak * tracker->window_peak * 256 *
+                          (uint64_t)tracker->window_frames;
+    int32_t crest_db = audio_ratio_db_fixed(peak_power, tracker->window_power) / 2;
+    return (crest_db > 0) ? crest_db : 0;
+}
+
+void peak_reset_window(peak_tracker_t *tracker) {
+    tracker->window_peak = 0;
+    tracker->window_power = 0;
+    tracker->window_frames = 0;
+    tracker->event_count = 0;
+}
+
+void peak_print_event(const peak_event_t *event) {
+    struct tm local;
+    char time_str[32];
+    char peak_str[16], background_str[16], ratio_str[16];
+
+    localtime_r(&event->timestamp.tv_sec, &local);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &local);
+
+    audio_format_volts(peak_str, sizeof(peak_str), (uint32_t)event->peak << 4);
+    audio_format_volts(background_str, sizeof(background_str), event->background_q4);
+    audio_format_db(ratio_str, sizeof(ratio_str), event->ratio_db);
+
+    printf("Impulse: %s.%03ld | Peak: %5s V | Background: %5s V | Ratio: %5s dB\n",
+           time_str, event->timestamp.tv_nsec / 1000000L,
+           peak_str, background_str, ratio_str);
+}
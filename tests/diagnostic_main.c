@@ -5,11 +5,16 @@
 #include <wiringPi.h>
 #include <wiringPiI2C.h>
 #include <time.h>
+#include <math.h>
 
-// Definições dos endereços I2C
-#define ADS1115_ADDR 0x48
-#define LCD_ADDR 0x27
-#define LED_GPIO 17
+#include "config.h"
+#include "adc.h"
+#include "archive.h"
+#include "arena.h"
+#include "audio.h"
+#include "lcd.h"
+#include "peak.h"
+#include "timing.h"
 
 // Cores para output (funciona na maioria dos terminais)
 #define COLOR_GREEN "\033[32m"
@@ -18,6 +23,46 @@
 #define COLOR_BLUE "\033[34m"
 #define COLOR_RESET "\033[0m"
 
+// Parâmetros do benchmark de ponto fixo
+#define BENCH_FRAMES 4096
+#define BENCH_ROUNDS 200
+#define BENCH_MAX_ERROR_DB 0.05f
+
+// Parâmetros do teste do codec: sinal amostrado como na aquisição real, com
+// NUM_SAMPLES conversões seguidas e a pausa até o próximo frame
+#define BENCH_ARCHIVE_BLOCKS 4          // Blocos codificados por nível
+#define BENCH_SAMPLE_PERIOD_US (CONVERSION_DELAY + 300)  // Conversão + escrita e leitura I2C
+#define BENCH_TONE_HZ 440.0
+#define BENCH_NOISE_BELOW_DB 10.0f      // Ruído de banda larga abaixo do tom
+#define BENCH_ADC_NOISE_COUNTS 1.0f     // Ruído próprio do ADS1115 (RMS)
+
+// Parâmetros do teste do rastreador de pico (contagens AC)
+#define PEAK_TEST_BACKGROUND 100        // Onda quadrada de fundo: RMS e pico = 100
+#define PEAK_TEST_IMPULSE 5000          // Impulso plano: pico = RMS = 5000 (34.0 dB)
+#define PEAK_TEST_SETTLE_FRAMES 300     // Convergência do fundo antes do impulso
+#define PEAK_TEST_DECAY_FRAMES 30       // Frames de decaimento verificados após a retenção
+#define PEAK_TEST_MAX_RATIO_ERROR_DB 0.1f
+
+// Parâmetros da caracterização do barramento I2C
+#define CHAR_TRANSACTIONS 2000          // Leituras para vazão e latência
+#define CHAR_HIST_BUCKET_US 50          // Largura das faixas do histograma de latência
+#define CHAR_HIST_BUCKETS 20            // Faixas do histograma (+1 para o excedente)
+#define CHAR_CONVERSIONS 10             // Conversões medidas por taxa do ADS1115
+#define CHAR_CONVERSION_TIMEOUT_US 200000
+#define CHAR_LCD_REFRESHES 5
+#define CHAR_BITS_PER_READ16 48         // Bits de clock de uma leitura SMBus de 16 bits
+#define CHAR_RATE_MARGIN 0.25           // Folga exigida do host acima da taxa nominal
+#define CHAR_I2C_CLOCK_PATH "/sys/class/i2c-adapter/i2c-1/of_node/clock-frequency"
+
+// Registradores do ADS1115
+#define ADS1115_REG_CONVERSION 0x00
+#define ADS1115_REG_CONFIG 0x01
+#define ADS1115_OS_READY 0x8000
+#define ADS1115_DR_MASK 0x00E0
+#define ADS1115_DR_SHIFT 5
+
+static const int ads1115_data_rates[8] = {8, 16, 32, 64, 128, 250, 475, 860};
+
 // Estrutura para manter estatísticas dos testes
 typedef struct {
     int total_tests;
@@ -104,7 +149,7 @@ void test_i2c_scan(test_stats_t* stats) {
     
     stats->total_tests += 2;
     test_i2c_device(ADS1115_ADDR, "ADS1115 (ADC)", stats);
-    test_i2c_device(LCD_ADDR, "LCD I2C Adapter", stats);
+    test_i2c_device(LCD_I2C_ADDR, "LCD I2C Adapter", stats);
 }
 
 // Teste 3: Verificação do GPIO (LED)
@@ -137,46 +182,51 @@ void test_gpio_led(test_stats_t* stats) {
     }
 }
 
+static int ads1115_write_config(int handle, uint16_t config) {
+    return wiringPiI2CWriteReg16(handle, ADS1115_REG_CONFIG, swap_bytes((int16_t)config));
+}
+
+// Leitura single-shot como no Sound Guard (ADS1115_CONFIG, CONVERSION_DELAY e
+// swap_bytes), mas reportando falhas do barramento: 0 = ok, -1 = escrita, -2 = leitura
+static int ads1115_read_checked(int handle, int16_t* value) {
+    if (ads1115_write_config(handle, ADS1115_CONFIG) < 0) {
+        return -1;
+    }
+    usleep(CONVERSION_DELAY);
+
+    int raw_value = wiringPiI2CReadReg16(handle, ADS1115_REG_CONVERSION);
+    if (raw_value < 0) {
+        return -2;
+    }
+    *value = swap_bytes((int16_t)raw_value);
+    return 0;
+}
+
 // Teste 4: Teste funcional do ADS1115
 int test_ads1115_functional(test_stats_t* stats) {
     printf("\n%s4. Teste funcional ADS1115...%s\n", COLOR_BLUE, COLOR_RESET);
     
     stats->total_tests++;
     
-    int handle = wiringPiI2CSetup(ADS1115_ADDR);
+    int handle = adc_init();
     if (handle < 0) {
         print_test_result("ADS1115 Functional", 0, "Não foi possível conectar");
         stats->failed_tests++;
         return 0;
     }
     
-    // Configura o ADS1115 para leitura single-ended do canal 0
-    // Config: AINp=AIN0, AINn=GND, gain=±2.048V, single-shot
-    int config = 0xC1E3; // Binary: 1100000111100011
-    
-    if (wiringPiI2CWriteReg16(handle, 0x01, ((config & 0xFF) << 8) | ((config >> 8) & 0xFF)) < 0) {
-        print_test_result("ADS1115 Functional", 0, "Falha ao escrever configuração");
-        stats->failed_tests++;
-        return 0;
-    }
-    
-    // Aguarda conversão
-    delay(100);
-    
-    // Lê o resultado da conversão
-    int raw_value = wiringPiI2CReadReg16(handle, 0x00);
-    if (raw_value < 0) {
-        print_test_result("ADS1115 Functional", 0, "Falha ao ler dados");
+    // Mesma configuração do Sound Guard: AIN0 vs. GND, ±2.048V, single-shot
+    int16_t raw_value;
+    int result = ads1115_read_checked(handle, &raw_value);
+    close(handle);
+    if (result < 0) {
+        print_test_result("ADS1115 Functional", 0,
+                          result == -1 ? "Falha ao escrever configuração" : "Falha ao ler dados");
         stats->failed_tests++;
         return 0;
     }
     
-    // Converte byte order (big-endian para little-endian)
-    raw_value = ((raw_value & 0xFF) << 8) | ((raw_value >> 8) & 0xFF);
-    if (raw_value > 32767) raw_value -= 65536; // Converte para signed
-    
-    // Converte para tensão (±2.048V range, 16-bit)
-    float voltage = (raw_value * 2.048) / 32767.0;
+    float voltage = raw_value * (ADC_FULL_SCALE / 32768.0f);
     
     char details[100];
     snprintf(details, sizeof(details), "Leitura: %.3fV (Raw: %d)", voltage, raw_value);
@@ -194,7 +244,7 @@ void test_system_integration(test_stats_t* stats) {
     
     printf("Executando 5 leituras consecutivas do ADC...\n");
     
-    int handle = wiringPiI2CSetup(ADS1115_ADDR);
+    int handle = adc_init();
     if (handle < 0) {
         print_test_result("System Integration", 0, "ADC não disponível");
         stats->failed_tests++;
@@ -206,26 +256,21 @@ void test_system_integration(test_stats_t* stats) {
     
     for (int i = 0; i < 5; i++) {
         // Configura e lê
-        int config = 0xC1E3;
-        if (wiringPiI2CWriteReg16(handle, 0x01, ((config & 0xFF) << 8) | ((config >> 8) & 0xFF)) >= 0) {
+        int16_t raw_value;
+        if (ads1115_read_checked(handle, &raw_value) == 0) {
+            float voltage = raw_value * (ADC_FULL_SCALE / 32768.0f);
+            voltage_sum += voltage;
+            successful_reads++;
+            printf("  Leitura %d: %.3fV\n", i+1, voltage);
+            
+            // Pisca o LED para cada leitura
+            digitalWrite(LED_GPIO, HIGH);
             delay(100);
-            int raw_value = wiringPiI2CReadReg16(handle, 0x00);
-            if (raw_value >= 0) {
-                raw_value = ((raw_value & 0xFF) << 8) | ((raw_value >> 8) & 0xFF);
-                if (raw_value > 32767) raw_value -= 65536;
-                float voltage = (raw_value * 2.048) / 32767.0;
-                voltage_sum += voltage;
-                successful_reads++;
-                printf("  Leitura %d: %.3fV\n", i+1, voltage);
-                
-                // Pisca o LED para cada leitura
-                digitalWrite(LED_GPIO, HIGH);
-                delay(100);
-                digitalWrite(LED_GPIO, LOW);
-                delay(200);
-            }
+            digitalWrite(LED_GPIO, LOW);
+            delay(200);
         }
     }
+    close(handle);
     
     if (successful_reads == 5) {
         char details[100];
@@ -241,6 +286,618 @@ void test_system_integration(test_stats_t* stats) {
     }
 }
 
+// Gera frames sintéticos (senóide + ruído) varrendo de -80 a 0 dBFS
+static void bench_generate_frames(adc_frame_t* frames, int count) {
+    const float counts_per_volt = 32768.0f / ADC_FULL_SCALE;
+    uint32_t seed = 12345;
+    float phase = 0.0f;
+
+    for (int f = 0; f < count; f++) {
+        float level_db = -80.0f + 80.0f * f / (count - 1);
+        float amplitude = MAX_RMS * 1.41421356f * powf(10.0f, level_db / 20.0f) * counts_per_volt;
+        for (int i = 0; i < NUM_SAMPLES; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            float noise = (float)((int32_t)(seed >> 16) - 32768) / 32768.0f;
+            float value = DC_OFFSET_COUNTS + amplitude * sinf(phase) + noise;
+            if (value > 32767.0f) value = 32767.0f;
+            if (value < -32768.0f) value = -32768.0f;
+            frames[f].samples[i] = (int16_t)lrintf(value);
+            phase += 0.9f;
+        }
+    }
+}
+
+// Ruído gaussiano (Box-Muller) com RMS 1, a partir de um gerador congruencial
+static float bench_gaussian(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    float u1 = ((*seed >> 8) + 1.0f) / 16777217.0f;
+    *seed = *seed * 1664525u + 1013904223u;
+    float u2 = (*seed >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// Gera frames com tom + ruído em level_db, nos instantes reais de amostragem:
+// as amostras de um frame ficam a BENCH_SAMPLE_PERIOD_US umas das outras e o
+// frame seguinte começa TARGET_INTERVAL_NS depois (pausa de ~16 ms)
+static void bench_generate_archive_frames(adc_frame_t* frames, int count, float level_db) {
+    const float counts_per_volt = 32768.0f / ADC_FULL_SCALE;
+    float signal_rms = MAX_RMS * powf(10.0f, level_db / 20.0f) * counts_per_volt;
+    float tone_amplitude = signal_rms * 1.41421356f;
+    float noise_rms = signal_rms * powf(10.0f, -BENCH_NOISE_BELOW_DB / 20.0f);
+    uint32_t seed = 12345;
+
+    for (int f = 0; f < count; f++) {
+        for (int i = 0; i < NUM_SAMPLES; i++) {
+            double t = f * (TARGET_INTERVAL_NS / 1e9) + i * (BENCH_SAMPLE_PERIOD_US / 1e6);
+            float value = DC_OFFSET_COUNTS
+                          + tone_amplitude * (float)sin(2.0 * M_PI * BENCH_TONE_HZ * t)
+                          + noise_rms * bench_gaussian(&seed)
+                          + BENCH_ADC_NOISE_COUNTS * bench_gaussian(&seed);
+            if (value > 32767.0f) value = 32767.0f;
+            if (value < -32768.0f) value = -32768.0f;
+            frames[f].samples[i] = (int16_t)lrintf(value);
+        }
+    }
+}
+
+// Teste 6: Caminho de ponto fixo vs. ponto flutuante (não requer hardware)
+void test_fixed_point(test_stats_t* stats) {
+    printf("\n%s6. Comparando caminhos de ponto fixo e flutuante...%s\n", COLOR_BLUE, COLOR_RESET);
+
+    stats->total_tests++;
+
+    static adc_frame_t frames[BENCH_FRAMES];
+    if (arena_init(audio_arena_size()) < 0 || audio_init() < 0) {
+        print_test_result("Fixed-Point Path", 0, "Falha ao inicializar tabelas de áudio");
+        stats->failed_tests++;
+        return;
+    }
+    bench_generate_frames(frames, BENCH_FRAMES);
+
+    // Precisão: dBFS e barra dos dois caminhos para os mesmos frames
+    float max_error = 0.0f;
+    int bar_mismatches = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        adc_frame_t frame_float = frames[f];
+        adc_frame_t frame_fixed = frames[f];
+        adc_process_frame_float(&frame_float);
+        adc_process_frame_fixed(&frame_fixed);
+
+        float db_float = audio_calculate_dbfs(frame_float.rms);
+        float db_fixed = audio_calculate_dbfs_fixed(frame_fixed.sum_squares) / (float)(1 << AUDIO_DB_FRAC_BITS);
+        float error = fabsf(db_float - db_fixed);
+        if (error > max_error) max_error = error;
+
+        int bar_float = audio_calculate_bar_length(audio_normalize_rms(frame_float.rms));
+        int bar_fixed = audio_calculate_bar_length_fixed(frame_fixed.sum_squares);
+        if (abs(bar_float - bar_fixed) > 1) bar_mismatches++;
+    }
+
+    // Desempenho: processamento de frame + dBFS + barra em cada caminho. O caminho
+    // fixo não executa nenhuma operação de ponto flutuante; o rastreador de pico é
+    // inteiro nos dois caminhos e por isso fica fora da comparação
+    struct timespec start, end;
+    volatile int sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            adc_process_frame_float(&frames[f]);
+            float db = audio_calculate_dbfs(frames[f].rms);
+            sink += audio_calculate_bar_length(audio_normalize_rms(frames[f].rms)) + (int)db;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double float_ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec))
+                      / ((double)BENCH_ROUNDS * BENCH_FRAMES);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            adc_process_frame_fixed(&frames[f]);
+            int32_t db = audio_calculate_dbfs_fixed(frames[f].sum_squares);
+            sink += audio_calculate_bar_length_fixed(frames[f].sum_squares) + db;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double fixed_ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec))
+                      / ((double)BENCH_ROUNDS * BENCH_FRAMES);
+
+    printf("  Erro máximo dBFS: %.4f dB (limite %.2f dB)\n", max_error, BENCH_MAX_ERROR_DB);
+    printf("  Barras divergentes (>1 passo): %d/%d\n", bar_mismatches, BENCH_FRAMES);
+    printf("  Ponto flutuante: %8.1f ns/frame\n", float_ns);
+    printf("  Ponto fixo:      %8.1f ns/frame (%.2fx)\n", fixed_ns, float_ns / fixed_ns);
+
+    char details[100];
+    if (max_error <= BENCH_MAX_ERROR_DB && bar_mismatches == 0) {
+        snprintf(details, sizeof(details), "Erro máx. %.4f dB, %.2fx mais rápido", max_error, float_ns / fixed_ns);
+        print_test_result("Fixed-Point Path", 1, details);
+        stats->passed_tests++;
+    } else {
+        snprintf(details, sizeof(details), "Erro máx. %.4f dB, %d barras divergentes", max_error, bar_mismatches);
+        print_test_result("Fixed-Point Path", 0, details);
+        stats->failed_tests++;
+    }
+}
+
+// Teste 7: Codec do arquivo de áudio (sem perdas) e razão de compressão por nível.
+// A razão depende do nível do sinal: só a reconstrução exata e a ausência de
+// expansão são exigidas; as razões são informativas
+void test_archive_codec(test_stats_t* stats) {
+    printf("\n%s7. Testando codec do arquivo de áudio...%s\n", COLOR_BLUE, COLOR_RESET);
+
+    stats->total_tests++;
+
+    static const float levels_db[] = {-70.0f, -50.0f, -30.0f, -10.0f};
+    static adc_frame_t frames[BENCH_ARCHIVE_BLOCKS * ARCHIVE_BLOCK_FRAMES];
+    static int16_t samples[ARCHIVE_BLOCK_SAMPLES];
+    static int16_t decoded[ARCHIVE_BLOCK_SAMPLES];
+    static uint8_t block[ARCHIVE_MAX_BLOCK_SIZE];
+
+    struct timespec start;
+    clock_gettime(CLOCK_REALTIME, &start);
+
+    int mismatches = 0;
+    int expanded = 0;
+    double min_ratio = 0.0;
+    double max_ratio = 0.0;
+
+    for (size_t l = 0; l < sizeof(levels_db) / sizeof(levels_db[0]); l++) {
+        bench_generate_archive_frames(frames, BENCH_ARCHIVE_BLOCKS * ARCHIVE_BLOCK_FRAMES, levels_db[l]);
+
+        size_t raw_total = 0;
+        size_t compressed_total = 0;
+        for (int b = 0; b < BENCH_ARCHIVE_BLOCKS; b++) {
+            for (int i = 0; i < ARCHIVE_BLOCK_FRAMES; i++) {
+                memcpy(samples + i * NUM_SAMPLES, frames[b * ARCHIVE_BLOCK_FRAMES + i].samples,
+                       sizeof(frames[0].samples));
+            }
+
+            size_t size = archive_encode_block(samples, ARCHIVE_BLOCK_SAMPLES, &start, 0, block, sizeof(block));
+            archive_block_info_t info;
+            int count = archive_decode_block(block, size, decoded, ARCHIVE_BLOCK_SAMPLES, &info);
+            if (size == 0 || count != ARCHIVE_BLOCK_SAMPLES ||
+                memcmp(samples, decoded, sizeof(samples)) != 0) {
+                mismatches++;
+            }
+            // O fallback literal limita o bloco às amostras brutas mais o cabeçalho
+            if (size > sizeof(samples) + ARCHIVE_HEADER_SIZE) {
+                expanded++;
+            }
+
+            raw_total += sizeof(samples);
+            compressed_total += size;
+        }
+
+        double ratio = compressed_total ? (double)raw_total / compressed_total : 0.0;
+        printf("  %6.1f dBFS: %zu -> %zu bytes (%.2f:1)\n", levels_db[l], raw_total, compressed_total, ratio);
+        if (l == 0 || ratio < min_ratio) min_ratio = ratio;
+        if (l == 0 || ratio > max_ratio) max_ratio = ratio;
+    }
+
+    char details[100];
+    if (mismatches == 0 && expanded == 0) {
+        snprintf(details, sizeof(details), "Sem perdas, razão de %.2f:1 a %.2f:1 conforme o nível",
+                 min_ratio, max_ratio);
+        print_test_result("Archive Codec", 1, details);
+        stats->passed_tests++;
+    } else if (mismatches == 0) {
+        snprintf(details, sizeof(details), "%d blocos maiores que o fallback literal", expanded);
+        print_test_result("Archive Codec", 0, details);
+        stats->failed_tests++;
+    } else {
+        snprintf(details, sizeof(details), "%d blocos divergentes após decodificação", mismatches);
+        print_test_result("Archive Codec", 0, details);
+        stats->failed_tests++;
+    }
+}
+
+// Frame sintético: onda quadrada de fundo ou impulso plano (sem overshoot do true-peak)
+static void peak_test_frame(adc_frame_t* frame, int impulse, int fixed) {
+    for (int i = 0; i < NUM_SAMPLES; i++) {
+        int ac = impulse ? PEAK_TEST_IMPULSE : ((i & 1) ? -PEAK_TEST_BACKGROUND : PEAK_TEST_BACKGROUND);
+        frame->samples[i] = (int16_t)(DC_OFFSET_COUNTS + ac);
+    }
+    if (fixed) {
+        adc_process_frame_fixed(frame);
+    } else {
+        adc_process_frame_float(frame);
+    }
+}
+
+// Roda a sequência do teste num caminho; retorna o número de falhas
+static int peak_test_sequence(int fixed, peak_tracker_t* tracker, char* failure, size_t size) {
+    const float expected_db = 20.0f * log10f((float)PEAK_TEST_IMPULSE / PEAK_TEST_BACKGROUND);
+    const float decay_db = PEAK_HOLD_DECAY_DB_S * (TARGET_INTERVAL_NS / 1e9f) * PEAK_TEST_DECAY_FRAMES;
+    adc_frame_t frame;
+    peak_event_t event;
+    int events = 0;
+
+    peak_init(tracker, PEAK_CREST_LIMIT_DB);
+
+    // Impulso durante o aquecimento: o fundo ainda não convergiu, sem evento
+    for (int f = 0; f < PEAK_TEST_SETTLE_FRAMES; f++) {
+        peak_test_frame(&frame, f == 2, fixed);
+        events += peak_update(tracker, &frame, &event);
+    }
+    if (events != 0) {
+        snprintf(failure, size, "%d evento(s) durante o aquecimento", events);
+        return 1;
+    }
+
+    // Um impulso: exatamente um evento, com a razão esperada
+    peak_test_frame(&frame, 1, fixed);
+    if (!peak_update(tracker, &frame, &event)) {
+        snprintf(failure, size, "impulso de %.1f dB não detectado", expected_db);
+        return 1;
+    }
+    float ratio_db = event.ratio_db / (float)(1 << AUDIO_DB_FRAC_BITS);
+    if (fabsf(ratio_db - expected_db) > PEAK_TEST_MAX_RATIO_ERROR_DB) {
+        snprintf(failure, size, "razão %.2f dB, esperado %.2f dB", ratio_db, expected_db);
+        return 1;
+    }
+
+    // Janela refratária: impulsos repetidos não geram novos eventos
+    for (int f = 0; f < PEAK_EVENT_REFRACTORY; f++) {
+        peak_test_frame(&frame, 1, fixed);
+        if (peak_update(tracker, &frame, &event)) {
+            snprintf(failure, size, "evento no frame %d da janela refratária", f + 1);
+            return 1;
+        }
+    }
+
+    // Peak-hold: retido por PEAK_HOLD_FRAMES e depois decai PEAK_HOLD_DECAY_DB_S
+    for (int f = 0; f < PEAK_HOLD_FRAMES; f++) {
+        peak_test_frame(&frame, 0, fixed);
+        peak_update(tracker, &frame, &event);
+    }
+    if (tracker->hold != PEAK_TEST_IMPULSE) {
+        snprintf(failure, size, "peak-hold %d durante a retenção, esperado %d",
+                 (int)tracker->hold, PEAK_TEST_IMPULSE);
+        return 1;
+    }
+    for (int f = 0; f < PEAK_TEST_DECAY_FRAMES; f++) {
+        peak_test_frame(&frame, 0, fixed);
+        peak_update(tracker, &frame, &event);
+    }
+    float hold_db = 20.0f * log10f((float)tracker->hold / PEAK_TEST_IMPULSE);
+    if (fabsf(hold_db + decay_db) > 0.5f) {
+        snprintf(failure, size, "decaimento de %.1f dB em %d frames, esperado %.1f dB",
+                 -hold_db, PEAK_TEST_DECAY_FRAMES, decay_db);
+        return 1;
+    }
+
+    // Após a janela refratária o próximo impulso volta a ser detectado
+    peak_test_frame(&frame, 1, fixed);
+    if (!peak_update(tracker, &frame, &event) || tracker->event_count != 2) {
+        snprintf(failure, size, "segundo impulso não detectado (%d eventos)", tracker->event_count);
+        return 1;
+    }
+    return 0;
+}
+
+// Teste 8: Rastreador de pico com impulso sintético (não requer hardware)
+void test_peak_tracker(test_stats_t* stats) {
+    printf("\n%s8. Testando rastreador de pico...%s\n", COLOR_BLUE, COLOR_RESET);
+
+    stats->total_tests++;
+
+    if (arena_init(audio_arena_size()) < 0 || audio_init() < 0) {
+        print_test_result("Peak Tracker", 0, "Falha ao inicializar tabelas de áudio");
+        stats->failed_tests++;
+        return;
+    }
+
+    peak_tracker_t tracker_float, tracker_fixed;
+    char failure[100] = "";
+    int failed = peak_test_sequence(0, &tracker_float, failure, sizeof(failure));
+    if (!failed) {
+        failed = peak_test_sequence(1, &tracker_fixed, failure, sizeof(failure));
+    }
+
+    // Paridade: os dois caminhos alimentam o rastreador com as mesmas contagens
+    if (!failed && (tracker_float.hold != tracker_fixed.hold ||
+                    tracker_float.background != tracker_fixed.background ||
+                    tracker_float.event_count != tracker_fixed.event_count)) {
+        snprintf(failure, sizeof(failure), "divergência flutuante/fixo (hold %d vs %d)",
+                 (int)tracker_float.hold, (int)tracker_fixed.hold);
+        failed = 1;
+    }
+
+    if (!failed) {
+        print_test_result("Peak Tracker", 1, "Evento, razão, refratário, decaimento e paridade OK");
+        stats->passed_tests++;
+    } else {
+        print_test_result("Peak Tracker", 0, failure);
+        stats->failed_tests++;
+    }
+}
+
+// ============================================================================
+// CARACTERIZAÇÃO DO BARRAMENTO I2C (modo não interativo, relatório JSON)
+// ============================================================================
+
+typedef struct {
+    int data_rate;                  // Taxa nominal (SPS)
+    int ready;                      // Todas as conversões sinalizaram OS = 1
+    double mean_us;                 // Tempo médio até conversão pronta
+    double max_us;                  // Pior tempo até conversão pronta
+    double throughput_sps;          // Amostras/s obtidas nesta taxa: conversão média + escrita e leitura no p99
+} char_conversion_t;
+
+typedef struct {
+    int ads_present;
+    double transactions_per_s;
+    double latency_min_us;
+    double latency_mean_us;
+    double latency_p50_us;
+    double latency_p90_us;
+    double latency_p99_us;
+    double latency_max_us;
+    int histogram[CHAR_HIST_BUCKETS + 1];
+    double effective_clock_hz;      // Limite inferior (inclui a sobrecarga da syscall)
+    double host_sps;                // Teto do barramento: escrita + leitura no p99, sem a conversão
+    long configured_clock_hz;       // -1 se não disponível
+    char_conversion_t conversions[8];
+    int recommended_rate;
+    int lcd_present;
+    double lcd_refresh_mean_ms;
+    double lcd_refresh_max_ms;
+} char_report_t;
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static double elapsed_us(struct timespec* start, struct timespec* end) {
+    return timespec_diff_ns(start, end) / 1000.0;
+}
+
+// Clock configurado no device tree (u32 big-endian), -1 se indisponível
+static long read_configured_i2c_clock(void) {
+    FILE* file = fopen(CHAR_I2C_CLOCK_PATH, "rb");
+    if (!file) return -1;
+    unsigned char bytes[4];
+    size_t count = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    if (count != sizeof(bytes)) return -1;
+    return ((long)bytes[0] << 24) | ((long)bytes[1] << 16) | ((long)bytes[2] << 8) | bytes[3];
+}
+
+// Vazão e distribuição de latência de leituras de 16 bits do ADS1115
+static void characterize_transactions(int handle, char_report_t* report) {
+    static long long latencies[CHAR_TRANSACTIONS];
+    struct timespec start, end, t0, t1;
+    int ok = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < CHAR_TRANSACTIONS; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int result = wiringPiI2CReadReg16(handle, ADS1115_REG_CONFIG);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (result >= 0) {
+            latencies[ok++] = timespec_diff_ns(&t0, &t1);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (ok == 0) return;
+
+    qsort(latencies, ok, sizeof(latencies[0]), compare_ll);
+
+    long long sum = 0;
+    for (int i = 0; i < ok; i++) {
+        sum += latencies[i];
+        int bucket = (int)(latencies[i] / 1000 / CHAR_HIST_BUCKET_US);
+        report->histogram[bucket < CHAR_HIST_BUCKETS ? bucket : CHAR_HIST_BUCKETS]++;
+    }
+
+    report->transactions_per_s = ok / (timespec_diff_ns(&start, &end) / 1e9);
+    report->latency_min_us = latencies[0] / 1000.0;
+    report->latency_mean_us = sum / (double)ok / 1000.0;
+    report->latency_p50_us = latencies[ok * 50 / 100] / 1000.0;
+    report->latency_p90_us = latencies[ok * 90 / 100] / 1000.0;
+    report->latency_p99_us = latencies[ok * 99 / 100] / 1000.0;
+    report->latency_max_us = latencies[ok - 1] / 1000.0;
+    // Limite inferior: a menor latência inclui a sobrecarga da syscall
+    if (report->latency_min_us > 0.0) {
+        report->effective_clock_hz = CHAR_BITS_PER_READ16 / (report->latency_min_us / 1e6);
+    }
+}
+
+// Tempo até OS = 1 (conversão pronta) para cada taxa de dados do ADS1115
+static void characterize_conversions(int handle, char_report_t* report) {
+    report->recommended_rate = 0;
+    if (report->latency_p99_us > 0.0) {
+        report->host_sps = 1e6 / (2.0 * report->latency_p99_us);
+    }
+
+    for (int dr = 0; dr < 8; dr++) {
+        char_conversion_t* conv = &report->conversions[dr];
+        uint16_t config = (ADS1115_CONFIG & ~ADS1115_DR_MASK) | (dr << ADS1115_DR_SHIFT);
+        double total_us = 0.0;
+        int measured = 0;
+
+        conv->data_rate = ads1115_data_rates[dr];
+        conv->ready = 1;
+        conv->max_us = 0.0;
+
+        for (int i = 0; i < CHAR_CONVERSIONS && conv->ready; i++) {
+            struct timespec t0, now;
+            if (ads1115_write_config(handle, config) < 0) {
+                conv->ready = 0;
+                break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+
+            // Consulta o bit OS até a conversão terminar
+            for (;;) {
+                int value = wiringPiI2CReadReg16(handle, ADS1115_REG_CONFIG);
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                if (value >= 0 && (swap_bytes((int16_t)value) & ADS1115_OS_READY)) break;
+                if (elapsed_us(&t0, &now) > CHAR_CONVERSION_TIMEOUT_US) {
+                    conv->ready = 0;
+                    break;
+                }
+            }
+
+            double us = elapsed_us(&t0, &now);
+            total_us += us;
+            measured++;
+            if (us > conv->max_us) conv->max_us = us;
+            wiringPiI2CReadReg16(handle, ADS1115_REG_CONVERSION);
+        }
+
+        conv->mean_us = measured ? total_us / measured : 0.0;
+        conv->throughput_sps = 0.0;
+
+        // Cada amostra custa a conversão medida mais a escrita da configuração e a
+        // leitura do resultado; o ADS1115 não entrega mais que a taxa nominal
+        if (conv->ready && measured > 0) {
+            double sample_us = conv->mean_us + 2.0 * report->latency_p99_us;
+            conv->throughput_sps = fmin(conv->data_rate, 1e6 / sample_us);
+        }
+
+        // Maior taxa cuja vazão fica dentro da folga da nominal (taxas em ordem crescente)
+        if (conv->throughput_sps > 0.0 &&
+            conv->throughput_sps >= conv->data_rate / (1.0 + CHAR_RATE_MARGIN)) {
+            report->recommended_rate = conv->data_rate;
+        }
+
+        fprintf(stderr, "  %3d SPS: média %8.1f us, máx %8.1f us, vazão %6.1f SPS%s\n",
+                conv->data_rate, conv->mean_us, conv->max_us, conv->throughput_sps,
+                conv->ready ? "" : " (sem resposta)");
+    }
+
+    // Restaura a configuração de produção
+    ads1115_write_config(handle, ADS1115_CONFIG);
+}
+
+// Tempo de reescrita completa das duas linhas do LCD
+static void characterize_lcd(char_report_t* report) {
+    // lcd_init() confirma que o display responde e libera o descritor se não
+    report->lcd_present = (lcd_init() == 0);
+    if (!report->lcd_present) {
+        return;
+    }
+
+    double total_ms = 0.0;
+    report->lcd_refresh_max_ms = 0.0;
+    for (int i = 0; i < CHAR_LCD_REFRESHES; i++) {
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        lcd_write((i & 1) ? "0123456789ABCDEF" : "FEDCBA9876543210",
+                  (i & 1) ? "Caracterizando.." : "..Caracterizando");
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double ms = elapsed_us(&t0, &t1) / 1000.0;
+        total_ms += ms;
+        if (ms > report->lcd_refresh_max_ms) report->lcd_refresh_max_ms = ms;
+    }
+    report->lcd_refresh_mean_ms = total_ms / CHAR_LCD_REFRESHES;
+    lcd_write("Diagnostico", "Concluido");
+}
+
+static void write_json_report(FILE* out, const char_report_t* report) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"ads1115\": {\n");
+    fprintf(out, "    \"address\": \"0x%02X\",\n", ADS1115_ADDR);
+    fprintf(out, "    \"present\": %s", report->ads_present ? "true" : "false");
+    if (report->ads_present) {
+        fprintf(out, ",\n    \"conversion\": [\n");
+        for (int dr = 0; dr < 8; dr++) {
+            const char_conversion_t* conv = &report->conversions[dr];
+            fprintf(out, "      {\"data_rate_sps\": %d, \"nominal_us\": %.1f, \"ready\": %s, "
+                         "\"mean_us\": %.1f, \"max_us\": %.1f, \"throughput_sps\": %.1f}%s\n",
+                    conv->data_rate, 1e6 / conv->data_rate, conv->ready ? "true" : "false",
+                    conv->mean_us, conv->max_us, conv->throughput_sps, dr < 7 ? "," : "");
+        }
+        fprintf(out, "    ],\n");
+        fprintf(out, "    \"recommended_data_rate_sps\": %d\n", report->recommended_rate);
+    } else {
+        fprintf(out, "\n");
+    }
+    fprintf(out, "  },\n");
+
+    fprintf(out, "  \"i2c\": {\n");
+    fprintf(out, "    \"transactions\": %d,\n", CHAR_TRANSACTIONS);
+    fprintf(out, "    \"transactions_per_second\": %.1f,\n", report->transactions_per_s);
+    fprintf(out, "    \"latency_us\": {\"min\": %.1f, \"mean\": %.1f, \"p50\": %.1f, "
+                 "\"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f},\n",
+            report->latency_min_us, report->latency_mean_us, report->latency_p50_us,
+            report->latency_p90_us, report->latency_p99_us, report->latency_max_us);
+    fprintf(out, "    \"histogram_us\": {\"bucket_width\": %d, \"counts\": [", CHAR_HIST_BUCKET_US);
+    for (int i = 0; i <= CHAR_HIST_BUCKETS; i++) {
+        fprintf(out, "%d%s", report->histogram[i], i < CHAR_HIST_BUCKETS ? ", " : "");
+    }
+    fprintf(out, "]},\n");
+    fprintf(out, "    \"effective_clock_hz_lower_bound\": %.0f,\n", report->effective_clock_hz);
+    fprintf(out, "    \"host_samples_per_second\": %.1f,\n", report->host_sps);
+    if (report->configured_clock_hz > 0) {
+        fprintf(out, "    \"configured_clock_hz\": %ld\n", report->configured_clock_hz);
+    } else {
+        fprintf(out, "    \"configured_clock_hz\": null\n");
+    }
+    fprintf(out, "  },\n");
+
+    fprintf(out, "  \"lcd\": {\n");
+    fprintf(out, "    \"address\": \"0x%02X\",\n", LCD_I2C_ADDR);
+    fprintf(out, "    \"present\": %s", report->lcd_present ? "true" : "false");
+    if (report->lcd_present) {
+        fprintf(out, ",\n    \"full_refresh_ms\": {\"mean\": %.2f, \"max\": %.2f}\n",
+                report->lcd_refresh_mean_ms, report->lcd_refresh_max_ms);
+    } else {
+        fprintf(out, "\n");
+    }
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+}
+
+// Modo de caracterização: sem prompts, progresso em stderr e JSON em stdout/arquivo
+int run_characterization(const char* output_path) {
+    static char_report_t report;
+    memset(&report, 0, sizeof(report));
+
+    if (wiringPiSetupGpio() < 0) {
+        fprintf(stderr, "Erro ao inicializar WiringPi (execute como root).\n");
+        return EXIT_FAILURE;
+    }
+
+    report.configured_clock_hz = read_configured_i2c_clock();
+
+    int handle = adc_init();
+    report.ads_present = (handle >= 0 && wiringPiI2CRead(handle) >= 0);
+
+    if (report.ads_present) {
+        fprintf(stderr, "Medindo %d transações I2C...\n", CHAR_TRANSACTIONS);
+        characterize_transactions(handle, &report);
+        fprintf(stderr, "Medindo tempo de conversão do ADS1115 por taxa...\n");
+        characterize_conversions(handle, &report);
+    } else {
+        fprintf(stderr, "ADS1115 não respondeu em 0x%02X.\n", ADS1115_ADDR);
+    }
+
+    fprintf(stderr, "Medindo reescrita completa do LCD...\n");
+    characterize_lcd(&report);
+
+    FILE* out = stdout;
+    if (output_path) {
+        out = fopen(output_path, "w");
+        if (!out) {
+            fprintf(stderr, "Erro ao abrir '%s' para escrita.\n", output_path);
+            return EXIT_FAILURE;
+        }
+    }
+    write_json_report(out, &report);
+    if (out != stdout) {
+        fclose(out);
+        fprintf(stderr, "Relatório salvo em %s\n", output_path);
+    }
+
+    return report.ads_present ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 // Função para imprimir resultado final
 void print_final_results(test_stats_t* stats) {
     printf("\n");
@@ -286,9 +943,17 @@ void print_help(const char* program_name) {
     printf("  -h, --help          Mostra esta mensagem de ajuda\n");
     printf("  -q, --quick         Executa apenas testes básicos\n");
     printf("  -v, --verbose       Modo verboso com detalhes extras\n");
+    printf("  -b, --bench         Testes sem hardware: ponto fixo, codec e rastreador de pico\n");
+    printf("                      e verifica o codec do arquivo de áudio\n");
+    printf("                      (não requer hardware nem root)\n");
+    printf("  -c, --characterize  Caracteriza o barramento I2C sem interação e\n");
+    printf("                      gera um relatório JSON\n");
+    printf("  -o, --output ARQ    Salva o relatório JSON em ARQ (padrão: stdout)\n");
     printf("\nEXEMPLOS:\n");
     printf("  sudo %s             # Executa todos os testes\n", program_name);
     printf("  sudo %s -q          # Executa apenas testes rápidos\n", program_name);
+    printf("  %s -b               # Benchmark de ponto fixo\n", program_name);
+    printf("  sudo %s -c -o i2c.json  # Caracterização do barramento\n", program_name);
     printf("\nNOTA:\n");
     printf("  Este programa deve ser executado como root (sudo)\n");
 }
@@ -296,6 +961,9 @@ void print_help(const char* program_name) {
 int main(int argc, char* argv[]) {
     int quick_mode = 0;
     int verbose_mode = 0;
+    int bench_mode = 0;
+    int characterize_mode = 0;
+    const char* output_path = NULL;
     
     // Processa argumentos da linha de comando
     for (int i = 1; i < argc; i++) {
@@ -309,6 +977,20 @@ int main(int argc, char* argv[]) {
         else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
             verbose_mode = 1;
         }
+        else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--bench") == 0) {
+            bench_mode = 1;
+        }
+        else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--characterize") == 0) {
+            characterize_mode = 1;
+        }
+        else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Opção '%s' requer um arquivo.\n", argv[i]);
+                print_help(argv[0]);
+                return EXIT_FAILURE;
+            }
+            output_path = argv[++i];
+        }
         else {
             fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
             print_help(argv[0]);
@@ -316,11 +998,24 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // A caracterização não imprime cabeçalho para manter o JSON limpo em stdout
+    if (characterize_mode) {
+        return run_characterization(output_path);
+    }
+    
     // Inicializa estatísticas
     test_stats_t stats = {0, 0, 0};
     
     print_header();
     
+    if (bench_mode) {
+        test_fixed_point(&stats);
+        test_archive_codec(&stats);
+        test_peak_tracker(&stats);
+        print_final_results(&stats);
+        return (stats.failed_tests == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
     if (getuid() != 0) {
         printf("%s⚠️  AVISO: Este programa deve ser executado como root (sudo)%s\n\n", COLOR_YELLOW, COLOR_RESET);
     }
@@ -0,0 +1,28 @@
+#!/usr/bin/env python3
+"""Gera include/log2_lut.h: tabela log2(1 + i/2^BITS) em Q16 para o caminho de ponto fixo.
+
+Uso: python3 tools/gen_log2_lut.py > include/log2_lut.h
+"""
+import math
+
+BITS = 8
+FRAC = 16
+
+entries = [round(math.log2(1.0 + i / (1 << BITS)) * (1 << FRAC)) for i in range((1 << BITS) + 1)]
+
+print("// Gerado por tools/gen_log2_lut.py - não editar manualmente")
+print("#ifndef LOG2_LUT_H")
+print("#define LOG2_LUT_H")
+print()
+print("#include <stdint.h>")
+print()
+print(f"#define LOG2_LUT_BITS {BITS}   // Bits da mantissa usados como índice")
+print(f"#define LOG2_LUT_FRAC {FRAC}  // Bits fracionários dos valores (Q{FRAC})")
+print()
+print(f"// log2(1 + i / {1 << BITS}) em Q{FRAC}, com uma entrada extra para interpolação")
+print(f"static const int32_t log2_lut[{(1 << BITS) + 1}] = {{")
+for i in range(0, len(entries), 8):
+    print("    " + ", ".join(f"{v:5d}" for v in entries[i:i + 8]) + ",")
+print("};")
+print()
+print("#endif // LOG2_LUT_H")